@@ -0,0 +1,131 @@
+#include "arraymetrics.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// Merges two sorted ranges into 'out' and returns the inversions between them: every time a
+// right element is taken first, it is smaller than all the left elements still waiting.
+long long mergeCount(const int* left, int nl, const int* right, int nr, int* out) {
+    long long inversions = 0;
+    int i = 0, j = 0;
+    while (i < nl && j < nr) {
+        if (right[j] < left[i]) {
+            inversions += nl - i;
+            *out++ = right[j++];
+        }
+        else {
+            *out++ = left[i++];
+        }
+    }
+    out = std::copy(left + i, left + nl, out);
+    std::copy(right + j, right + nr, out);
+    return inversions;
+}
+
+// Bottom-up merge sort of data[lo, hi) using tmp[lo, hi) as scratch; leaves the result in data.
+long long sortCount(int* data, int* tmp, int lo, int hi) {
+    long long inversions = 0;
+    int* src = data;
+    int* dst = tmp;
+    for (int width = 1; width < hi - lo; width *= 2) {
+        for (int l = lo; l < hi; l += 2 * width) {
+            int m = std::min(l + width, hi);
+            int r = std::min(l + 2 * width, hi);
+            inversions += mergeCount(src + l, m - l, src + m, r - m, dst + l);
+        }
+        std::swap(src, dst);
+    }
+    if (src != data) std::copy(src + lo, src + hi, data + lo);
+    return inversions;
+}
+
+int longestNonDecreasing(const std::vector<int>& a) {
+    // tails[k]: smallest possible last value of a subsequence of length k + 1
+    std::vector<int> tails;
+    for (int v : a) {
+        auto it = std::upper_bound(tails.begin(), tails.end(), v);
+        if (it == tails.end()) tails.push_back(v);
+        else *it = v;
+    }
+    return static_cast<int>(tails.size());
+}
+
+long long countInversions(std::vector<int>& data, int threads) {
+    const int n = static_cast<int>(data.size());
+    std::vector<int> tmp(data.size());
+    if (threads <= 1) return sortCount(data.data(), tmp.data(), 0, n);
+
+    // block k is [bounds[k], bounds[k + 1]); every block is sorted on its own thread
+    std::vector<int> bounds;
+    for (int t = 0; t <= threads; ++t) bounds.push_back(static_cast<int>(static_cast<long long>(n) * t / threads));
+    std::vector<long long> counts(threads, 0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] { counts[t] = sortCount(data.data(), tmp.data(), bounds[t], bounds[t + 1]); });
+    }
+    for (auto& th : pool) th.join();
+
+    // then neighbouring blocks are merged pairwise, one thread per pair, until one block is left
+    int* src = data.data();
+    int* dst = tmp.data();
+    while (bounds.size() > 2) {
+        const int blocks = static_cast<int>(bounds.size()) - 1;
+        std::vector<long long> level((blocks + 1) / 2, 0);
+        pool.clear();
+        for (int p = 0; p < blocks; p += 2) {
+            int l = bounds[p];
+            int m = bounds[p + 1];
+            int r = p + 2 <= blocks ? bounds[p + 2] : m;
+            pool.emplace_back([&, p, l, m, r] { level[p / 2] = mergeCount(src + l, m - l, src + m, r - m, dst + l); });
+        }
+        for (auto& th : pool) th.join();
+        for (long long c : level) counts.push_back(c);
+
+        std::vector<int> merged;
+        for (int p = 0; p < blocks; p += 2) merged.push_back(bounds[p]);
+        merged.push_back(n);
+        bounds.swap(merged);
+        std::swap(src, dst);
+    }
+    if (src != data.data()) std::copy(src, src + n, data.data());
+
+    long long inversions = 0;
+    for (long long c : counts) inversions += c;
+    return inversions;
+}
+
+} // namespace
+
+double ArrayMetrics::disorder() const {
+    if (n < 2) return 0;
+    return static_cast<double>(inversions) / (static_cast<double>(n) * (n - 1) / 2);
+}
+
+ArrayMetrics computeArrayMetrics(const std::vector<int>& a, int parallelThreshold) {
+    ArrayMetrics m;
+    m.n = static_cast<int>(a.size());
+    if (m.n == 0) return m;
+
+    const bool parallel = m.n >= parallelThreshold;
+    int threads = 1;
+    if (parallel) threads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+
+    // the LIS scan is inherently sequential, so on large inputs it runs beside the inversion count
+    std::thread lisWorker;
+    if (parallel) lisWorker = std::thread([&] { m.longestIncreasing = longestNonDecreasing(a); });
+    else m.longestIncreasing = longestNonDecreasing(a);
+
+    m.runs = 1;
+    for (int k = 1; k < m.n; ++k) m.runs += a[k] < a[k - 1];
+
+    // counting inversions sorts the copy, which then gives the distinct values for free
+    std::vector<int> sorted = a;
+    m.inversions = countInversions(sorted, threads);
+    m.distinct = 1;
+    for (int k = 1; k < m.n; ++k) m.distinct += sorted[k] != sorted[k - 1];
+
+    if (lisWorker.joinable()) lisWorker.join();
+    return m;
+}
@@ -0,0 +1,24 @@
+#ifndef ARRAYMETRICS_H
+#define ARRAYMETRICS_H
+
+#include <vector>
+
+// Exact measures of how much order an array already has. Unlike the best/average/worst
+// complexity text they depend on the actual input, and they predict the work of the adaptive
+// algorithms directly: insertion and gnome sort shift once per inversion, Tim sort merges runs.
+struct ArrayMetrics {
+    int n = 0;
+    long long inversions = 0;   // pairs i < j with a[i] > a[j]
+    int runs = 0;               // maximal non-descending runs
+    int longestIncreasing = 0;  // length of the longest non-decreasing subsequence
+    int distinct = 0;           // number of different values
+
+    // inversions as a fraction of n(n-1)/2: 0 when sorted, 1 when strictly reversed
+    double disorder() const;
+};
+
+// O(n log n). Inputs of at least 'parallelThreshold' elements count inversions on several threads
+// (merge counting per block, then pairwise merges) while another computes the LIS.
+ArrayMetrics computeArrayMetrics(const std::vector<int>& a, int parallelThreshold = 1 << 16);
+
+#endif // ARRAYMETRICS_H
@@ -0,0 +1,234 @@
+#include "arrayview.h"
+
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOption>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QResizeEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const int kMargin = 10;
+const int kHeaderHeight = 28;
+const int kLabelHeight = 22;
+const double kFitBarWidth = 30.0;   // pitch of a bar when the whole array fits (20px bar + 10px gap)
+const double kMaxBarWidth = 240.0;  // deepest zoom
+const double kLabelMinWidth = 24.0; // value labels are only drawn when they fit under the bar
+const double kZoomStep = 1.25;      // per wheel notch
+}
+
+ArrayView::ArrayView(QWidget* parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(160);
+}
+
+void ArrayView::setValues(const std::vector<int>* v) {
+    values = v;
+    clampView();
+}
+
+void ArrayView::setColorFunction(ColorFunction fn) {
+    colorOf = std::move(fn);
+}
+
+void ArrayView::setNeutralColor(const QColor& color) {
+    neutralColor = color;
+}
+
+void ArrayView::setHeader(const QString& text) {
+    header = text;
+}
+
+void ArrayView::resetZoom() {
+    zoomed = false;
+    clampView();
+    update();
+}
+
+double ArrayView::plotWidth() const {
+    return std::max(1, width() - 2 * kMargin);
+}
+
+double ArrayView::fitBarWidth() const {
+    int n = count();
+    if (n == 0) return kFitBarWidth;
+    return std::min(kFitBarWidth, plotWidth() / n);
+}
+
+void ArrayView::clampView() {
+    double fit = fitBarWidth();
+    if (!zoomed || barWidth <= fit) {
+        zoomed = false;
+        barWidth = fit;
+        firstIndex = 0.0;
+        return;
+    }
+
+    barWidth = std::min(barWidth, kMaxBarWidth);
+    double visible = plotWidth() / barWidth;
+    firstIndex = std::clamp(firstIndex, 0.0, std::max(0.0, count() - visible));
+}
+
+int ArrayView::firstVisibleIndex() const {
+    return std::min(count(), static_cast<int>(firstIndex));
+}
+
+int ArrayView::lastVisibleIndex() const {
+    double last = std::ceil(firstIndex + plotWidth() / barWidth);
+    return static_cast<int>(std::min<double>(count(), last));
+}
+
+void ArrayView::paintEvent(QPaintEvent*) {
+    QPainter p(this);
+
+    // let the style sheet draw background and border
+    QStyleOption opt;
+    opt.initFrom(this);
+    style()->drawPrimitive(QStyle::PE_Widget, &opt, &p, this);
+
+    clampView(); // the vector may have been resized since the last paint
+
+    if (!header.isEmpty()) {
+        QFont f = p.font();
+        f.setBold(true);
+        p.setFont(f);
+        p.setPen(QColor("#DFDFDF"));
+        p.drawText(QRect(kMargin, 4, width() - 2 * kMargin, kHeaderHeight - 4), Qt::AlignLeft | Qt::AlignVCenter, header);
+        f.setBold(false);
+        p.setFont(f);
+    }
+
+    int n = count();
+    if (n == 0) return;
+
+    const std::vector<int>& arr = *values;
+    int maxVal = *std::max_element(arr.begin(), arr.end());
+    bool labels = barWidth >= kLabelMinWidth;
+
+    QRectF plot(kMargin, kHeaderHeight, plotWidth(), height() - kHeaderHeight - (labels ? kLabelHeight : kMargin));
+    double baseline = plot.bottom();
+    auto heightOf = [&](int val) {
+        return (maxVal > 0 && val > 0) ? val * plot.height() / maxVal : 0.0;
+    };
+    auto colorAt = [&](int k) {
+        return colorOf ? colorOf(k) : neutralColor;
+    };
+
+    int first = firstVisibleIndex();
+    int last = lastVisibleIndex();
+
+    if (barWidth >= 3.0) {
+        // one rectangle per element
+        double bw = barWidth >= 6.0 ? barWidth * 2.0 / 3.0 : barWidth - 1.0;
+        QPen outline = barWidth >= 8.0 ? QPen(Qt::black) : QPen(Qt::NoPen);
+
+        for (int k = first; k < last; ++k) {
+            double x = plot.left() + (k - firstIndex) * barWidth;
+            double h = heightOf(arr[k]);
+
+            p.setPen(outline);
+            p.setBrush(colorAt(k));
+            p.drawRect(QRectF(x, baseline - h, bw, h));
+
+            if (labels) {
+                p.setPen(QColor("#DFDFDF"));
+                p.drawText(QRectF(x, baseline + 2, barWidth, kLabelHeight - 2), Qt::AlignLeft | Qt::AlignTop, QString::number(arr[k]));
+            }
+        }
+    }
+    else {
+        // several elements share a pixel column: draw the tallest, and keep highlights visible
+        int columns = static_cast<int>(plot.width());
+        for (int c = 0; c < columns; ++c) {
+            int begin = static_cast<int>(firstIndex + c / barWidth);
+            int end = std::max(begin + 1, static_cast<int>(firstIndex + (c + 1) / barWidth));
+            if (begin >= n) break;
+            end = std::min(end, n);
+
+            int tallest = arr[begin];
+            QColor color = neutralColor;
+            bool highlighted = false;
+            for (int k = begin; k < end; ++k) {
+                tallest = std::max(tallest, arr[k]);
+                if (!highlighted) {
+                    QColor ck = colorAt(k);
+                    if (ck != neutralColor) {
+                        color = ck;
+                        highlighted = true;
+                    }
+                }
+            }
+
+            double x = plot.left() + c + 0.5;
+            p.setPen(color);
+            p.drawLine(QPointF(x, baseline), QPointF(x, baseline - heightOf(tallest)));
+        }
+    }
+
+    if (zoomed) {
+        p.setPen(QColor("#A0A0A0"));
+        p.drawText(QRect(kMargin, 4, width() - 2 * kMargin, kHeaderHeight - 4), Qt::AlignRight | Qt::AlignVCenter,
+                   QString("[%1, %2) of %3").arg(first).arg(last).arg(n));
+    }
+}
+
+void ArrayView::wheelEvent(QWheelEvent* event) {
+    double steps = event->angleDelta().y() / 120.0;
+    if (count() == 0 || steps == 0.0) {
+        event->ignore();
+        return;
+    }
+
+    // keep the element under the cursor in place
+    double anchorX = event->position().x() - kMargin;
+    double anchorIndex = firstIndex + anchorX / barWidth;
+
+    barWidth *= std::pow(kZoomStep, steps);
+    zoomed = true;
+    firstIndex = anchorIndex - anchorX / barWidth;
+    clampView();
+
+    update();
+    event->accept();
+}
+
+void ArrayView::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton && zoomed) {
+        panning = true;
+        lastMousePos = event->pos();
+        setCursor(Qt::ClosedHandCursor);
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void ArrayView::mouseMoveEvent(QMouseEvent* event) {
+    if (panning) {
+        int dx = event->pos().x() - lastMousePos.x();
+        lastMousePos = event->pos();
+        firstIndex -= dx / barWidth;
+        clampView();
+        update();
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void ArrayView::mouseReleaseEvent(QMouseEvent* event) {
+    if (panning && event->button() == Qt::LeftButton) {
+        panning = false;
+        unsetCursor();
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void ArrayView::mouseDoubleClickEvent(QMouseEvent* event) {
+    resetZoom();
+    QWidget::mouseDoubleClickEvent(event);
+}
+
+void ArrayView::resizeEvent(QResizeEvent* event) {
+    clampView();
+    QWidget::resizeEvent(event);
+}
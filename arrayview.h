@@ -0,0 +1,63 @@
+#ifndef ARRAYVIEW_H
+#define ARRAYVIEW_H
+
+#include <QWidget>
+#include <QColor>
+#include <QString>
+#include <QPoint>
+#include <functional>
+#include <vector>
+
+// Bar-chart viewport for the array being sorted.
+// Only the index range currently on screen is painted. Wheel zooms around the cursor, dragging
+// pans, and a double-click fits the whole array again. When several elements share a pixel
+// column they are drawn as one column (tallest value, first highlighted colour), so painting
+// costs O(visible elements) no matter how large the array is.
+class ArrayView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    using ColorFunction = std::function<QColor(int)>;
+
+    explicit ArrayView(QWidget* parent = nullptr);
+
+    // The view does not copy the values; the vector must outlive the view or be replaced.
+    void setValues(const std::vector<int>* values);
+    void setColorFunction(ColorFunction fn);
+    // Colour treated as "nothing special" when columns are merged at low zoom levels.
+    void setNeutralColor(const QColor& color);
+    void setHeader(const QString& text);
+
+    void resetZoom();
+    int firstVisibleIndex() const;
+    int lastVisibleIndex() const; // exclusive
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    int count() const { return values ? static_cast<int>(values->size()) : 0; }
+    double plotWidth() const;
+    double fitBarWidth() const;
+    void clampView();
+
+    const std::vector<int>* values = nullptr;
+    ColorFunction colorOf;
+    QColor neutralColor = QColor(200, 200, 200);
+    QString header;
+
+    double barWidth = 30.0;   // pixels per element
+    double firstIndex = 0.0;  // element at the left edge of the plot
+    bool zoomed = false;      // false = fit the whole array
+    bool panning = false;
+    QPoint lastMousePos;
+};
+
+#endif // ARRAYVIEW_H
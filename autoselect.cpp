@@ -0,0 +1,154 @@
+#include "autoselect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+const int kPairSamples = 1024;
+const int kValueSamples = 1024;
+
+// splitmix64 with a fixed seed: the same input always gets the same verdict
+struct SampleRng {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    int below(int n) { return static_cast<int>(next() % static_cast<uint64_t>(n)); }
+};
+
+int decimalDigits(long long v) {
+    int d = 1;
+    while (v >= 10) {
+        v /= 10;
+        ++d;
+    }
+    return d;
+}
+
+// The exact inversion count of a, or -1 once it passes 'cap': insertion sort on a copy that is
+// built as it goes, counting shifts and stopping at the cap, so it costs O(n + cap) on sorted
+// input and a few thousand elements' worth on a shuffled one.
+long long boundedInversions(const std::vector<int>& a, long long cap) {
+    std::vector<int> sorted;
+    sorted.reserve(a.size());
+    long long inversions = 0;
+    for (int v : a) {
+        sorted.push_back(v);
+        size_t j = sorted.size() - 1;
+        for (; j > 0 && sorted[j - 1] > v; --j) sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+        inversions += static_cast<long long>(sorted.size() - 1 - j);
+        if (inversions > cap) return -1;
+    }
+    return inversions;
+}
+
+std::string format(const char* fmt, double a, double b = 0) {
+    char buf[160];
+    std::snprintf(buf, sizeof buf, fmt, a, b);
+    return buf;
+}
+}
+
+Presortedness measurePresortedness(const std::vector<int>& a) {
+    Presortedness p;
+    p.n = static_cast<int>(a.size());
+    if (p.n == 0) return p;
+
+    int lo = a[0], hi = a[0];
+    p.runs = 1;
+    for (int k = 1; k < p.n; ++k) {
+        p.runs += a[k] < a[k - 1];
+        lo = std::min(lo, a[k]);
+        hi = std::max(hi, a[k]);
+    }
+    p.range = static_cast<long long>(hi) - lo;
+    if (p.runs == 1) return p; // already sorted; nothing left to sample
+
+    SampleRng rng;
+    const int pairSamples = std::min(kPairSamples, p.n);
+    int inverted = 0;
+    for (int s = 0; s < pairSamples; ++s) {
+        int i = rng.below(p.n);
+        int j = rng.below(p.n);
+        if (i == j) j = (j + 1) % p.n;
+        if (i > j) std::swap(i, j);
+        inverted += a[i] > a[j];
+    }
+    p.inversionRatio = static_cast<double>(inverted) / pairSamples;
+    // 1024 sampled pairs cannot tell a handful of far swaps from none at all
+    p.inversions = boundedInversions(a, static_cast<long long>(kInsertionShifts) * p.n);
+
+    // a sample, not the array: sorting it must stay cheap next to sorting the input
+    std::vector<int> sample(std::max(2, std::min(kValueSamples, p.n / 8)));
+    for (int& v : sample) v = a[rng.below(p.n)];
+    std::sort(sample.begin(), sample.end());
+    int repeats = 0;
+    for (size_t k = 1; k < sample.size(); ++k) repeats += sample[k] == sample[k - 1];
+    p.duplicateRatio = static_cast<double>(repeats) / sample.size();
+
+    return p;
+}
+
+SortAlgorithm chooseAlgorithm(const Presortedness& p, std::string* reason) {
+    auto because = [reason](const std::string& why) {
+        if (reason) *reason = why;
+    };
+    const double n = std::max(2, p.n);
+    const double log2n = std::log2(n);
+
+    // insertion sort does one shift per inversion; this is the sampled estimate
+    double estimatedInversions = p.inversionRatio * n * (n - 1) / 2;
+
+    // up to 32 elements the compiled-in networks run without a single branch on the data
+    if (p.n <= SortEngine::kMaxFixedNetwork && p.runs > 1 && estimatedInversions > n) {
+        because(format("only %.0f elements: the unrolled sorting network beats insertion sort's branches", n));
+        return SortAlgorithm::Network;
+    }
+    if (p.runs == 1 || p.inversions >= 0) {
+        because(format("nearly sorted (%.0f inversions, %.0f runs): insertion sort is close to linear",
+                       static_cast<double>(p.inversions), p.runs));
+        return SortAlgorithm::Insertion;
+    }
+    if (estimatedInversions <= kInsertionShifts * n) {
+        because(format("looks nearly sorted (%.0f runs), but has more than %.0f inversions: natural merge sort "
+                       "gallops over the sorted stretches", p.runs, kInsertionShifts * n));
+        return SortAlgorithm::NaturalMerge;
+    }
+
+    // a key range no wider than max(2n, 4096) is one counting pass and one pass of fills
+    if (SortEngine::countingSortApplies(p.n, p.range)) {
+        because(format("only %.0f distinct key values for %.0f elements: counting sort is two linear passes",
+                       static_cast<double>(p.range + 1), n));
+        return SortAlgorithm::Counting;
+    }
+
+    // radix costs about two quick sort levels per decimal digit of the key range
+    int digits = decimalDigits(p.range);
+    if (2 * digits < log2n) {
+        because(format("key range needs only %.0f decimal digits for %.0f elements: radix sort is linear",
+                       digits, n));
+        return SortAlgorithm::Radix;
+    }
+
+    // quick sort's last-element pivot degrades on presorted input and on heavy duplicates
+    if (p.runs < n / 8 || p.inversionRatio < 0.25 || p.inversionRatio > 0.75) {
+        because(format("long runs (%.0f runs, %.0f%% sampled inversions): natural merge sort merges the runs it "
+                       "finds instead of hitting quick sort's presorted worst case", p.runs, 100 * p.inversionRatio));
+        return SortAlgorithm::NaturalMerge;
+    }
+    if (p.duplicateRatio > 0.05) {
+        because(format("%.0f%% duplicate keys: 3-way partitioning finishes equal keys in one pass, Lomuto does not",
+                       100 * p.duplicateRatio));
+        return SortAlgorithm::Quick3;
+    }
+
+    because(format("no exploitable order (%.0f%% sampled inversions, %.0f%% duplicates): quick sort",
+                   100 * p.inversionRatio, 100 * p.duplicateRatio));
+    return SortAlgorithm::Quick;
+}
@@ -0,0 +1,29 @@
+#ifndef AUTOSELECT_H
+#define AUTOSELECT_H
+
+#include <string>
+#include <vector>
+
+#include "sortengine.h"
+
+// How much order the input already has. Taken in one O(n) pass plus fixed-size samples, so it
+// costs a small fraction of any sort.
+struct Presortedness {
+    int n = 0;
+    int runs = 0;               // maximal non-descending runs
+    double inversionRatio = 0;  // sampled fraction of pairs i < j with a[i] > a[j]
+    long long inversions = 0;   // exact count of those pairs, or -1 when above kInsertionShifts * n
+    double duplicateRatio = 0;  // sampled fraction of elements equal to another sampled one
+    long long range = 0;        // max - min
+};
+
+// Insertion sort is only chosen for input it sorts in at most this many shifts per element.
+constexpr int kInsertionShifts = 4;
+
+Presortedness measurePresortedness(const std::vector<int>& a);
+
+// Picks the engine algorithm expected to be fastest for input with these properties.
+// 'reason' receives a one-line explanation for the log.
+SortAlgorithm chooseAlgorithm(const Presortedness& p, std::string* reason = nullptr);
+
+#endif // AUTOSELECT_H
@@ -0,0 +1,126 @@
+#include "bitonicsort.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "simdsort.h"
+
+namespace SortEngine {
+
+namespace {
+
+// Below this many elements per thread the barriers cost more than the extra thread saves.
+const int kElementsPerThread = 1 << 14;
+
+// Every stage reads what the previous one wrote, so all workers wait here between stages.
+class StageBarrier {
+public:
+    explicit StageBarrier(int count) : count(count) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        const long long current = generation;
+        if (++arrived == count) {
+            arrived = 0;
+            ++generation;
+            changed.notify_all();
+            return;
+        }
+        changed.wait(lock, [&] { return generation != current; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    const int count;
+    int arrived = 0;
+    long long generation = 0;
+};
+
+// Pairs [from, to) of one stage. Pair p lies in span p / half of 2 * half elements, at offset
+// t = p % half: it pairs base + t with base + half + t, or with its mirror base + 2 * half - 1 - t.
+// Pairs whose upper element is past n would compare with padding and are skipped.
+void runPairs(int* a, long long n, long long half, bool mirrored, long long from, long long to) {
+    for (long long p = from; p < to;) {
+        const long long base = p / half * 2 * half;
+        const long long t = p % half;
+        const long long end = t + std::min(half - t, to - p);
+        if (mirrored) {
+            const long long first = std::max(t, base + 2 * half - n);
+            if (first < end) simdMinMaxMirrored(a + base + first, a + base + 2 * half - 1 - first, static_cast<int>(end - first));
+        }
+        else {
+            const long long last = std::min(end, n - base - half);
+            if (last > t) simdMinMax(a + base + t, a + base + half + t, static_cast<int>(last - t));
+        }
+        p += end - t;
+    }
+}
+
+// Sorts the kSimdBlock-sized blocks [from, to): in full by the SIMD kernel when 'initial', from
+// bitonic otherwise (the last, partial block is sorted in full either way).
+void runBlocks(int* a, long long n, long long from, long long to, bool initial) {
+    for (long long b = from; b < to; ++b) {
+        const long long begin = b * kSimdBlock;
+        const int size = static_cast<int>(std::min<long long>(kSimdBlock, n - begin));
+        if (initial || size < kSimdBlock) simdSortSmall(a + begin, size);
+        else simdBitonicFinish(a + begin);
+    }
+}
+
+} // namespace
+
+int bitonicThreads(long long n, int threads) {
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    return static_cast<int>(std::max<long long>(1, std::min<long long>(threads, n / kElementsPerThread)));
+}
+
+void parallelBitonicSort(std::vector<int>& a, int threads) {
+    const long long n = static_cast<long long>(a.size());
+    if (n <= kSimdBlock) {
+        simdSortSmall(a.data(), static_cast<int>(n));
+        return;
+    }
+
+    long long padded = kSimdBlock;
+    while (padded < n) padded *= 2;
+    const long long pairs = padded / 2;
+    const long long blocks = (n + kSimdBlock - 1) / kSimdBlock;
+
+    threads = bitonicThreads(n, threads);
+    StageBarrier barrier(threads);
+
+    // worker w owns the same share of every stage; shares start at multiples of kSimdBlock pairs
+    // so the vector loops rarely end in a scalar tail
+    auto share = [threads](long long total, int w, long long grain) {
+        return total * w / threads / grain * grain;
+    };
+    auto worker = [&](int w) {
+        int* data = a.data();
+        const long long blockFrom = share(blocks, w, 1), blockTo = w + 1 == threads ? blocks : share(blocks, w + 1, 1);
+        const long long pairFrom = share(pairs, w, kSimdBlock), pairTo = w + 1 == threads ? pairs : share(pairs, w + 1, kSimdBlock);
+
+        runBlocks(data, n, blockFrom, blockTo, true);
+        barrier.wait();
+        for (long long k = 2 * kSimdBlock; k <= padded; k *= 2) {
+            runPairs(data, n, k / 2, true, pairFrom, pairTo);
+            barrier.wait();
+            for (long long d = k / 4; d >= kSimdBlock; d /= 2) {
+                runPairs(data, n, d, false, pairFrom, pairTo);
+                barrier.wait();
+            }
+            // the stages below kSimdBlock stay inside one block and run in registers
+            runBlocks(data, n, blockFrom, blockTo, false);
+            barrier.wait();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int w = 1; w < threads; ++w) pool.emplace_back(worker, w);
+    worker(0);
+    for (auto& t : pool) t.join();
+}
+
+} // namespace SortEngine
@@ -0,0 +1,21 @@
+#ifndef BITONICSORT_H
+#define BITONICSORT_H
+
+#include <vector>
+
+namespace SortEngine {
+
+// Bitonic sort as it would run in production rather than in the visualizer: blocks of
+// kSimdBlock are sorted by the SIMD kernel, then every merge stage's compare-exchanges are split
+// evenly over 'threads' workers (0: one per core) that meet at a barrier between stages. Each
+// worker handles contiguous runs of pairs with vector min/max. Elements past n behave like
+// +infinity padding, so any n works.
+void parallelBitonicSort(std::vector<int>& a, int threads = 0);
+
+// The number of workers parallelBitonicSort uses for n elements: small inputs get fewer, since
+// every stage ends at a barrier.
+int bitonicThreads(long long n, int threads = 0);
+
+} // namespace SortEngine
+
+#endif // BITONICSORT_H
@@ -0,0 +1,203 @@
+#include "countingsort.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "simdsort.h"
+
+namespace SortEngine {
+
+namespace {
+
+// Below this many elements per thread, starting the thread costs more than it saves.
+const int kElementsPerThread = 1 << 16;
+
+// Up to this many keys the four striped histograms still fit in L1.
+const long long kStripedKeys = 1 << 10;
+
+const int kBucketTarget = 16;
+// More buckets than this and the scatter's write streams no longer fit in the caches.
+const int kMaxBuckets = 1 << 12;
+// Up to this many keys, the parallel sort gives every key its own bucket and never scatters.
+const int kMaxKeyBuckets = 1 << 16;
+
+// Runs work(w) for w = 0 .. threads - 1, the first on the calling thread, and waits for all.
+template <typename Work>
+void inParallel(int threads, Work work) {
+    std::vector<std::thread> pool;
+    for (int w = 1; w < threads; ++w) pool.emplace_back(work, w);
+    work(0);
+    for (auto& t : pool) t.join();
+}
+
+// Sorts a bucket of keys from lowest .. lowest + span - 1, using scratch[0, size): small buckets
+// with the SIMD kernel, buckets with no more keys than elements by counting, and the rest by
+// another bucket pass over their own span, which is never wider than the parent's bucket.
+void sortBucket(int* p, int* scratch, int size, uint32_t lowest, long long span) {
+    if (size <= kSimdBlock) {
+        simdSortSmall(p, size);
+        return;
+    }
+    if (span <= size) {
+        std::vector<int> count(span, 0);
+        for (int k = 0; k < size; ++k) ++count[static_cast<uint32_t>(p[k]) - lowest];
+        for (long long v = 0; v < span; ++v) p = std::fill_n(p, count[v], static_cast<int>(lowest + static_cast<uint32_t>(v)));
+        return;
+    }
+
+    // span > size > buckets, so the shift is at least 1 and every level narrows the span
+    const int buckets = bucketCount(size);
+    const int shift = bucketShift(span - 1, buckets);
+    std::vector<int> start(buckets + 1, 0);
+    for (int k = 0; k < size; ++k) ++start[((static_cast<uint32_t>(p[k]) - lowest) >> shift) + 1];
+    for (int b = 1; b <= buckets; ++b) start[b] += start[b - 1];
+    std::vector<int> next(start.begin(), start.end() - 1);
+    for (int k = 0; k < size; ++k) scratch[next[(static_cast<uint32_t>(p[k]) - lowest) >> shift]++] = p[k];
+    std::copy(scratch, scratch + size, p);
+    for (int b = 0; b < buckets; ++b) {
+        sortBucket(p + start[b], scratch + start[b], start[b + 1] - start[b], lowest + (static_cast<uint32_t>(b) << shift),
+                   1LL << shift);
+    }
+}
+
+} // namespace
+
+void keyRange(const int* p, long long n, int& lo, int& hi) {
+    int minValue = p[0], maxValue = p[0];
+    for (long long k = 1; k < n; ++k) {
+        minValue = std::min(minValue, p[k]);
+        maxValue = std::max(maxValue, p[k]);
+    }
+    lo = minValue;
+    hi = maxValue;
+}
+
+bool countingSortApplies(long long n, long long range) {
+    return range < std::min(kMaxCountingRange, std::max<long long>(2 * n, 4096));
+}
+
+void denseCountingSort(std::vector<int>& a, int minValue, long long range) {
+    const long long n = static_cast<long long>(a.size());
+    const long long keys = range + 1;
+    const uint32_t base = static_cast<uint32_t>(minValue);
+    const int* p = a.data();
+    auto key = [base](int v) { return static_cast<uint32_t>(v) - base; };
+
+    std::vector<int> count;
+    if (keys <= kStripedKeys) {
+        // runs of equal keys would otherwise increment one counter back to back
+        count.assign(4 * keys, 0);
+        int* c0 = count.data();
+        int* c1 = c0 + keys;
+        int* c2 = c1 + keys;
+        int* c3 = c2 + keys;
+        long long k = 0;
+        for (; k + 4 <= n; k += 4) {
+            ++c0[key(p[k])];
+            ++c1[key(p[k + 1])];
+            ++c2[key(p[k + 2])];
+            ++c3[key(p[k + 3])];
+        }
+        for (; k < n; ++k) ++c0[key(p[k])];
+        for (long long v = 0; v < keys; ++v) c0[v] += c1[v] + c2[v] + c3[v];
+    }
+    else {
+        count.assign(keys, 0);
+        for (long long k = 0; k < n; ++k) ++count[key(p[k])];
+    }
+
+    int* out = a.data();
+    for (long long v = 0; v < keys; ++v) out = std::fill_n(out, count[v], static_cast<int>(base + static_cast<uint32_t>(v)));
+}
+
+int bucketCount(long long n) {
+    // at least two, so that any 32-bit range needs a shift of at most 31
+    int buckets = 2;
+    while (buckets < kMaxBuckets && static_cast<long long>(buckets) * kBucketTarget < n) buckets *= 2;
+    return buckets;
+}
+
+int bucketShift(long long range, int buckets) {
+    int shift = 0;
+    while ((range >> shift) >= buckets) ++shift;
+    return shift;
+}
+
+int bucketThreads(long long n, int threads) {
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    return static_cast<int>(std::max<long long>(1, std::min<long long>(threads, n / kElementsPerThread)));
+}
+
+void parallelBucketSort(std::vector<int>& a, int threads) {
+    const int n = static_cast<int>(a.size());
+    if (n <= kSimdBlock) {
+        simdSortSmall(a.data(), n);
+        return;
+    }
+    threads = bucketThreads(n, threads);
+    auto slice = [n, threads](int w) { return static_cast<int>(static_cast<long long>(n) * w / threads); };
+
+    std::vector<int> lo(threads), hi(threads);
+    inParallel(threads, [&](int w) { keyRange(a.data() + slice(w), slice(w + 1) - slice(w), lo[w], hi[w]); });
+    const int minValue = *std::min_element(lo.begin(), lo.end());
+    const long long range = static_cast<long long>(*std::max_element(hi.begin(), hi.end())) - minValue;
+    const bool keyBuckets = range < kMaxKeyBuckets;
+    const int buckets = keyBuckets ? static_cast<int>(range) + 1 : bucketCount(n);
+    const int shift = keyBuckets ? 0 : bucketShift(range, buckets);
+
+    std::vector<int> histograms(static_cast<size_t>(threads) * buckets, 0);
+    inParallel(threads, [&](int w) {
+        int* h = histograms.data() + static_cast<size_t>(w) * buckets;
+        for (int k = slice(w); k < slice(w + 1); ++k) ++h[bucketOf(a[k], minValue, shift)];
+    });
+
+    // bucket b holds worker 0's elements of b, then worker 1's, ...: each histogram entry becomes
+    // that worker's first write position, which keeps the scatter stable
+    std::vector<int> start(buckets + 1);
+    int position = 0;
+    for (int b = 0; b < buckets; ++b) {
+        start[b] = position;
+        for (int w = 0; w < threads; ++w) {
+            int& h = histograms[static_cast<size_t>(w) * buckets + b];
+            const int count = h;
+            h = position;
+            position += count;
+        }
+    }
+    start[buckets] = n;
+
+    // workers take whole buckets, split where the bucket starts cross their slice boundaries
+    auto bucketsOf = [&](int w) {
+        auto first = std::lower_bound(start.begin(), start.begin() + buckets, slice(w));
+        auto last = std::lower_bound(start.begin(), start.begin() + buckets, slice(w + 1));
+        if (w + 1 == threads) last = start.begin() + buckets;
+        return std::make_pair(static_cast<int>(first - start.begin()), static_cast<int>(last - start.begin()));
+    };
+
+    // one key per bucket: the histogram is the answer, and writing it out is a run of fills
+    if (shift == 0) {
+        inParallel(threads, [&](int w) {
+            auto [first, last] = bucketsOf(w);
+            for (int b = first; b < last; ++b) std::fill(a.begin() + start[b], a.begin() + start[b + 1], minValue + b);
+        });
+        return;
+    }
+
+    std::vector<int> scattered(n);
+    inParallel(threads, [&](int w) {
+        int* h = histograms.data() + static_cast<size_t>(w) * buckets;
+        for (int k = slice(w); k < slice(w + 1); ++k) scattered[h[bucketOf(a[k], minValue, shift)]++] = a[k];
+    });
+    // a's copy of a bucket is free once scattered, so it is the bucket's scratch space
+    inParallel(threads, [&](int w) {
+        auto [first, last] = bucketsOf(w);
+        for (int b = first; b < last; ++b) {
+            int* p = scattered.data() + start[b];
+            const int size = start[b + 1] - start[b];
+            sortBucket(p, a.data() + start[b], size, static_cast<uint32_t>(minValue) + (static_cast<uint32_t>(b) << shift), 1LL << shift);
+            std::copy(p, p + size, a.begin() + start[b]);
+        }
+    });
+}
+
+} // namespace SortEngine
@@ -0,0 +1,47 @@
+#ifndef COUNTINGSORT_H
+#define COUNTINGSORT_H
+
+#include <cstdint>
+#include <vector>
+
+namespace SortEngine {
+
+// The smallest and largest of p[0, n), n > 0, in a loop compilers vectorize (the pairwise
+// branches of std::minmax_element cost five times as much).
+void keyRange(const int* p, long long n, int& lo, int& hi);
+
+// Counting sort pays one counter per key in the range, so it only takes inputs whose range is
+// small next to n (at most twice n, at least 4096 keys, never more than kMaxCountingRange);
+// the rest go to radix sort.
+constexpr long long kMaxCountingRange = 1 << 22;
+bool countingSortApplies(long long n, long long range);
+
+// The production counting sort for keys minValue .. minValue + range: one histogram pass (striped
+// over four tables for small ranges, so equal keys do not wait on each other's increments) and
+// one pass of memset-like fills.
+void denseCountingSort(std::vector<int>& a, int minValue, long long range);
+
+// Bucket sort splits the keys by their top bits: bucketCount(n) buckets (a power of two, about 16
+// elements each, at most 4096) and bucketOf(v) = (v - min) >> bucketShift(range, buckets), so the
+// buckets are ordered and a small range gives buckets of one key each, which need no sorting.
+int bucketCount(long long n);
+int bucketShift(long long range, int buckets);
+inline int bucketOf(int v, int minValue, int shift) {
+    return static_cast<int>((static_cast<uint32_t>(v) - static_cast<uint32_t>(minValue)) >> shift);
+}
+
+// Bucket sort as it would run in production: every worker histograms its own slice, the
+// histograms' prefix sums give each worker its own stable write positions, the slices are
+// scattered in parallel, and the buckets are then sorted and copied back, split evenly by size.
+// Up to 65536 distinct keys every key gets its own bucket, and the histograms are the whole sort.
+// Buckets beyond kSimdBlock elements are counted when they hold few distinct keys and split again
+// by their next bits otherwise.
+// 'threads' 0 means one per core.
+void parallelBucketSort(std::vector<int>& a, int threads = 0);
+
+// The number of workers parallelBucketSort uses for n elements.
+int bucketThreads(long long n, int threads = 0);
+
+} // namespace SortEngine
+
+#endif // COUNTINGSORT_H
@@ -0,0 +1,63 @@
+#include "cutofftuner.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "inputgenerator.h"
+
+namespace {
+const int kRuns = 5;
+}
+
+const std::vector<int>& cutoffCandidates() {
+    static const std::vector<int> candidates = { 0, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+    return candidates;
+}
+
+int tuneCutoff(SortAlgorithm alg, const SortOptions& base, std::vector<CutoffTiming>* timings, int n) {
+    GeneratorOptions generator;
+    generator.distribution = Distribution::Uniform32;
+    generator.size = n;
+    generator.seed = 0x7E57;
+    const std::vector<int> input = generateInput(generator);
+
+    // radix only applies the cutoff to the whole input, so it is timed on many small inputs
+    // instead: consecutive slices of 1 to twice the largest candidate elements
+    std::vector<std::vector<int>> pieces;
+    if (alg == SortAlgorithm::Radix) {
+        const int longest = 2 * cutoffCandidates().back();
+        for (int begin = 0, k = 0; begin < n; ++k) {
+            int end = std::min(n, begin + 1 + (k * 7919) % longest);
+            pieces.emplace_back(input.begin() + begin, input.begin() + end);
+            begin = end;
+        }
+    }
+    else {
+        pieces.push_back(input);
+    }
+
+    int best = 0;
+    double bestMs = 0;
+    std::vector<std::vector<int>> work;
+    for (int cutoff : cutoffCandidates()) {
+        SortOptions options = base;
+        options.cutoff = cutoff;
+
+        double ms = 0;
+        for (int r = 0; r < kRuns; ++r) {
+            SortEngine::NullTracer untraced;
+            work = pieces; // copied before the clock starts, so only the sorting is timed
+            auto start = std::chrono::steady_clock::now();
+            for (std::vector<int>& piece : work) SortEngine::run(alg, piece, untraced, options);
+            double t = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            ms = r == 0 ? t : std::min(ms, t);
+        }
+
+        if (timings) timings->push_back({ cutoff, ms });
+        if (cutoff == cutoffCandidates().front() || ms < bestMs) {
+            best = cutoff;
+            bestMs = ms;
+        }
+    }
+    return best;
+}
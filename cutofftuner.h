@@ -0,0 +1,23 @@
+#ifndef CUTOFFTUNER_H
+#define CUTOFFTUNER_H
+
+#include <vector>
+
+#include "sortengine.h"
+
+struct CutoffTiming {
+    int cutoff;
+    double ms;  // best of several runs
+};
+
+// Candidate cutoffs tried by tuneCutoff; 0 is the plain algorithm.
+const std::vector<int>& cutoffCandidates();
+
+// Times 'alg' (untraced) on the same random input of n elements for every candidate cutoff and
+// returns the fastest, so the choice fits this CPU's caches and branch predictor. Radix sort only
+// applies its cutoff to a whole input, so it is timed on many small slices instead. 'base'
+// supplies the other options (pivot strategy, small-range sort).
+int tuneCutoff(SortAlgorithm alg, const SortOptions& base, std::vector<CutoffTiming>* timings = nullptr,
+               int n = 200000);
+
+#endif // CUTOFFTUNER_H
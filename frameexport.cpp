@@ -0,0 +1,219 @@
+#include "frameexport.h"
+
+#include <QFile>
+#include <QPainter>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+const int kMargin = 10;
+const int kHeaderHeight = 28;
+const int kFramesPerThread = 32; // per batch; keeps Y4M buffers small
+
+const QColor kBackground(0x25, 0x25, 0x26);
+const QColor kText(0xDF, 0xDF, 0xDF);
+const QColor kNeutral(200, 200, 200);
+const QColor kSorted(0, 255, 0);
+const QColor kCompared(220, 20, 60);
+const QColor kPivot(186, 85, 211);
+
+QColor colorAt(const TraceFrame& f, int k) {
+    if (k == f.pivot) return kPivot;
+    if (k == f.i || k == f.j) return kCompared;
+    if (f.sorted.contains(k)) return kSorted;
+    return kNeutral;
+}
+
+// Full-range BT.601 (the "C420jpeg" colour space), chroma averaged over 2x2 blocks.
+void appendYuv420(const QImage& image, QByteArray& out) {
+    const int w = image.width();
+    const int h = image.height();
+    int offset = out.size();
+    out.resize(offset + w * h + 2 * (w / 2) * (h / 2));
+    uchar* y = reinterpret_cast<uchar*>(out.data()) + offset;
+    uchar* u = y + w * h;
+    uchar* v = u + (w / 2) * (h / 2);
+
+    for (int row = 0; row < h; ++row) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(row));
+        for (int col = 0; col < w; ++col)
+            *y++ = static_cast<uchar>((77 * qRed(line[col]) + 150 * qGreen(line[col]) + 29 * qBlue(line[col])) >> 8);
+    }
+
+    for (int row = 0; row + 1 < h; row += 2) {
+        const QRgb* top = reinterpret_cast<const QRgb*>(image.constScanLine(row));
+        const QRgb* bottom = reinterpret_cast<const QRgb*>(image.constScanLine(row + 1));
+        for (int col = 0; col + 1 < w; col += 2) {
+            int r = qRed(top[col]) + qRed(top[col + 1]) + qRed(bottom[col]) + qRed(bottom[col + 1]);
+            int g = qGreen(top[col]) + qGreen(top[col + 1]) + qGreen(bottom[col]) + qGreen(bottom[col + 1]);
+            int b = qBlue(top[col]) + qBlue(top[col + 1]) + qBlue(bottom[col]) + qBlue(bottom[col + 1]);
+            *u++ = static_cast<uchar>(std::clamp(((-43 * r - 85 * g + 128 * b) >> 10) + 128, 0, 255));
+            *v++ = static_cast<uchar>(std::clamp(((128 * r - 107 * g - 21 * b) >> 10) + 128, 0, 255));
+        }
+    }
+}
+
+QString pngPath(const QString& prefix, int index) {
+    return QString("%1_%2.png").arg(prefix).arg(index, 6, 10, QChar('0'));
+}
+}
+
+void renderTraceFrame(const TraceFrame& f, int frameIndex, int frameCount, const QString& title, QImage& image) {
+    image.fill(kBackground);
+    QPainter p(&image);
+
+    const int w = image.width();
+    const int h = image.height();
+    p.setPen(kText);
+    p.drawText(QRect(kMargin, 4, w - 2 * kMargin, kHeaderHeight - 4), Qt::AlignLeft | Qt::AlignVCenter, title);
+    p.drawText(QRect(kMargin, 4, w - 2 * kMargin, kHeaderHeight - 4), Qt::AlignRight | Qt::AlignVCenter,
+               QString("Step %1 / %2").arg(frameIndex).arg(frameCount - 1));
+
+    const std::vector<int>& arr = f.array;
+    const int n = static_cast<int>(arr.size());
+    if (n == 0) return;
+
+    int maxVal = *std::max_element(arr.begin(), arr.end());
+    QRectF plot(kMargin, kHeaderHeight, w - 2 * kMargin, h - kHeaderHeight - kMargin);
+    double baseline = plot.bottom();
+    auto heightOf = [&](int val) {
+        return (maxVal > 0 && val > 0) ? val * plot.height() / maxVal : 0.0;
+    };
+
+    double barWidth = plot.width() / n;
+    if (barWidth >= 3.0) {
+        double bw = barWidth >= 6.0 ? barWidth * 2.0 / 3.0 : barWidth - 1.0;
+        p.setPen(Qt::NoPen);
+        for (int k = 0; k < n; ++k) {
+            double bh = heightOf(arr[k]);
+            p.setBrush(colorAt(f, k));
+            p.drawRect(QRectF(plot.left() + k * barWidth, baseline - bh, bw, bh));
+        }
+    }
+    else {
+        // same column merging as ArrayView: tallest value, first highlighted colour
+        int columns = static_cast<int>(plot.width());
+        for (int c = 0; c < columns; ++c) {
+            int begin = static_cast<int>(c / barWidth);
+            int end = std::min(n, std::max(begin + 1, static_cast<int>((c + 1) / barWidth)));
+            if (begin >= n) break;
+
+            int tallest = arr[begin];
+            QColor color = kNeutral;
+            for (int k = begin; k < end; ++k) {
+                tallest = std::max(tallest, arr[k]);
+                if (color == kNeutral) color = colorAt(f, k);
+            }
+
+            double x = plot.left() + c + 0.5;
+            p.setPen(color);
+            p.drawLine(QPointF(x, baseline), QPointF(x, baseline - heightOf(tallest)));
+        }
+    }
+}
+
+bool exportTraceFrames(const QString& tracePath, const FrameExportOptions& options, QString& error,
+                       const std::function<bool(int, int)>& progress) {
+    TraceReader probe;
+    if (!probe.open(tracePath)) {
+        error = probe.errorString();
+        return false;
+    }
+    const int frameCount = probe.frameCount();
+    const QString title = probe.header().algorithm;
+    probe.close();
+
+    std::vector<int> selected;
+    const int every = std::max(1, options.every);
+    for (int f = 0; f < frameCount; f += every) selected.push_back(f);
+    if (frameCount > 0 && selected.back() != frameCount - 1) selected.push_back(frameCount - 1);
+    const int total = static_cast<int>(selected.size());
+
+    const bool y4m = options.format == FrameExportOptions::Format::Y4m;
+    // 4:2:0 chroma needs even dimensions
+    const int width = y4m ? std::max(2, options.width & ~1) : std::max(1, options.width);
+    const int height = y4m ? std::max(2, options.height & ~1) : std::max(1, options.height);
+
+    QFile video;
+    if (y4m) {
+        video.setFileName(options.outputPath);
+        if (!video.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            error = video.errorString();
+            return false;
+        }
+        video.write(QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C420jpeg\n")
+                        .arg(width).arg(height).arg(std::max(1, options.fps)).toLatin1());
+    }
+
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, total));
+
+    // one reader per worker; the file is mapped, so they share the pages
+    std::vector<TraceReader> readers(threads);
+    for (TraceReader& r : readers) {
+        if (!r.open(tracePath)) {
+            error = r.errorString();
+            return false;
+        }
+    }
+
+    const int batchSize = threads * kFramesPerThread;
+    std::vector<QByteArray> encoded(y4m ? batchSize : 0);
+    std::vector<QString> errors(threads);
+
+    for (int batchStart = 0; batchStart < total; batchStart += batchSize) {
+        const int batchEnd = std::min(total, batchStart + batchSize);
+        const int perThread = (batchEnd - batchStart + threads - 1) / threads;
+
+        auto work = [&](int t) {
+            QImage image(width, height, QImage::Format_RGB32);
+            int first = batchStart + t * perThread;
+            int last = std::min(batchEnd, first + perThread);
+            for (int s = first; s < last; ++s) {
+                if (!readers[t].seek(selected[s])) {
+                    errors[t] = readers[t].errorString();
+                    return;
+                }
+                renderTraceFrame(readers[t].frame(), selected[s], frameCount, title, image);
+                if (y4m) {
+                    QByteArray& out = encoded[s - batchStart];
+                    out = "FRAME\n";
+                    appendYuv420(image, out);
+                }
+                else if (!image.save(pngPath(options.outputPath, s), "PNG")) {
+                    errors[t] = "Could not write " + pngPath(options.outputPath, s);
+                    return;
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; ++t) pool.emplace_back(work, t);
+        work(0);
+        for (auto& th : pool) th.join();
+
+        for (const QString& e : errors) {
+            if (!e.isEmpty()) {
+                error = e;
+                return false;
+            }
+        }
+
+        if (y4m) {
+            for (int s = batchStart; s < batchEnd; ++s) {
+                if (video.write(encoded[s - batchStart]) < 0) {
+                    error = video.errorString();
+                    return false;
+                }
+            }
+        }
+
+        if (progress && !progress(batchEnd, total)) {
+            error = "Export cancelled.";
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef FRAMEEXPORT_H
+#define FRAMEEXPORT_H
+
+#include <QImage>
+#include <QString>
+#include <functional>
+
+#include "trace.h"
+
+struct FrameExportOptions {
+    enum class Format { PngSequence, Y4m };
+
+    Format format = Format::PngSequence;
+    // PNG: file name prefix, frames become <prefix>_000000.png, ...; Y4M: the video file
+    QString outputPath;
+    int every = 1;        // export every Nth frame (the last frame is always included)
+    int width = 1280;
+    int height = 720;
+    int fps = 30;
+    int threads = 0;      // 0 = one per core
+};
+
+// Draws one trace frame as a bar chart (sorted bars green, i/j red, pivot purple).
+void renderTraceFrame(const TraceFrame& frame, int frameIndex, int frameCount, const QString& title, QImage& image);
+
+// Renders the selected frames of a trace offscreen, without a window or the live timer.
+// Worker threads each open their own reader and render a contiguous block of frames, so they
+// mostly decode forward; Y4M frames are written in order by the calling thread.
+// 'progress' is called from the calling thread between batches and may return false to cancel.
+bool exportTraceFrames(const QString& tracePath, const FrameExportOptions& options, QString& error,
+                       const std::function<bool(int done, int total)>& progress = {});
+
+#endif // FRAMEEXPORT_H
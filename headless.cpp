@@ -0,0 +1,509 @@
+#include "headless.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "autoselect.h"
+#include "cutofftuner.h"
+#include "inputgenerator.h"
+#include "losertree.h"
+#include "sortengine.h"
+#include "trace.h"
+
+namespace {
+
+// Counts work and, when a writer is attached, records every step as a trace frame. The trace has
+// to see every write, so this probe takes the traced paths; --stats times come from NullTracer.
+struct HeadlessProbe : SortEngine::NullTracer {
+    static constexpr bool records = true;
+
+    TraceWriter* trace = nullptr;
+    long long comparisons = 0;
+    long long steps = 0;
+    int peakDepth = 0;
+    int lastI = -1, lastJ = -1;
+    std::vector<int> written; // reused, so recording a step allocates nothing
+
+    void compare(int i, int j) {
+        ++comparisons;
+        lastI = i;
+        lastJ = j;
+    }
+    void step(const std::vector<int>& a, int i, int j = -1) {
+        ++steps;
+        if (!trace) return;
+        // only the written elements go to the writer; diffing all of a made every frame O(n)
+        written.clear();
+        written.push_back(i);
+        if (j >= 0) written.push_back(j);
+        trace->addFrame(a, written, lastI, lastJ, -1, {}, {});
+    }
+    void depth(int d) { peakDepth = std::max(peakDepth, d); }
+};
+
+struct Job {
+    QString input;
+    std::vector<int> generated; // used instead of reading 'input' when --generate is given
+    SortOptions options;
+    QString output;
+    QString tracePath;
+    bool pivotVariant = false; // another --pivot all strategy; dropped when auto picks a sort without a pivot
+
+    QString error;
+    bool duplicate = false; // a pivotVariant whose pick ignores the pivot; not reported
+    SortAlgorithm algorithm = SortAlgorithm::Quick; // the one that ran, after --algo auto
+    QString reason;                                 // why auto picked it
+    int elements = 0;
+    double bestMs = 0;
+    double medianMs = 0;
+    long long comparisons = 0;
+    long long steps = 0;
+    int peakDepth = 0;
+};
+
+// --pivot all and --gaps all only fan out over the algorithms that read the option.
+bool readsPivot(SortAlgorithm alg) {
+    return alg == SortAlgorithm::Quick || alg == SortAlgorithm::Quick3 || alg == SortAlgorithm::DualPivot;
+}
+
+bool readsGaps(SortAlgorithm alg) {
+    return alg == SortAlgorithm::Shell;
+}
+
+// "*.bin" files hold raw little-endian int32 values; anything else is text with numbers
+// separated by whitespace or commas, like the GUI's input field.
+bool isBinary(const QString& path) {
+    return path.endsWith(".bin", Qt::CaseInsensitive);
+}
+
+bool readNumbers(const QString& path, std::vector<int>& out, QString& error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    QByteArray data = file.readAll();
+    out.clear();
+
+    if (isBinary(path)) {
+        if (data.size() % 4 != 0) {
+            error = "size is not a multiple of 4 bytes";
+            return false;
+        }
+        out.resize(data.size() / 4);
+        const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+        for (size_t k = 0; k < out.size(); ++k) out[k] = qFromLittleEndian<qint32>(p + 4 * k);
+        return true;
+    }
+
+    for (const QByteArray& token : data.replace(',', ' ').simplified().split(' ')) {
+        if (token.isEmpty()) continue;
+        bool ok = false;
+        int v = token.toInt(&ok);
+        if (!ok) {
+            error = "not a number: " + QString::fromLatin1(token.left(32));
+            return false;
+        }
+        out.push_back(v);
+    }
+    return true;
+}
+
+bool writeNumbers(const QString& path, const std::vector<int>& values, QString& error) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = file.errorString();
+        return false;
+    }
+
+    QByteArray data;
+    if (isBinary(path)) {
+        data.resize(static_cast<int>(values.size() * 4));
+        uchar* p = reinterpret_cast<uchar*>(data.data());
+        for (size_t k = 0; k < values.size(); ++k) qToLittleEndian<qint32>(values[k], p + 4 * k);
+    }
+    else {
+        for (size_t k = 0; k < values.size(); ++k) {
+            data += QByteArray::number(values[k]);
+            data += (k + 1 == values.size()) ? '\n' : ' ';
+        }
+    }
+
+    if (file.write(data) != data.size()) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// 'tuned' holds the per-algorithm cutoffs of --cutoff auto, or is null to keep job.options.cutoff.
+void runJob(Job& job, SortAlgorithm alg, bool autoSelect, const std::map<SortAlgorithm, int>* tuned, int repeats,
+            bool counted) {
+    std::vector<int> a;
+    if (!job.generated.empty()) a.swap(job.generated);
+    else if (!readNumbers(job.input, a, job.error)) return;
+    job.elements = static_cast<int>(a.size());
+
+    // Timed with the untraced instantiation, so the time is the algorithm's alone. With auto
+    // selection the presortedness probe is part of every timed run.
+    std::vector<double> times;
+    std::vector<int> sorted;
+    for (int r = 0; r < repeats; ++r) {
+        std::vector<int> work = a;
+        SortEngine::NullTracer untraced;
+        auto start = std::chrono::steady_clock::now();
+        if (autoSelect) {
+            std::string why;
+            alg = chooseAlgorithm(measurePresortedness(work), r == 0 ? &why : nullptr);
+            if (r == 0) job.reason = QString::fromStdString(why);
+        }
+        if (tuned) {
+            auto it = tuned->find(alg);
+            job.options.cutoff = it != tuned->end() ? it->second : 0;
+        }
+        SortEngine::run(alg, work, untraced, job.options);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        if (r == 0) sorted.swap(work);
+        if (job.pivotVariant && !readsPivot(alg)) {
+            job.duplicate = true;
+            return;
+        }
+    }
+    job.algorithm = alg;
+    std::sort(times.begin(), times.end());
+    job.bestMs = times.front();
+    job.medianMs = times[times.size() / 2];
+
+    // Counts and the trace come from a separate instrumented run.
+    if (!counted && job.tracePath.isEmpty()) {
+        if (!job.output.isEmpty()) writeNumbers(job.output, sorted, job.error);
+        return;
+    }
+
+    HeadlessProbe probe;
+    TraceWriter writer;
+    if (!job.tracePath.isEmpty()) {
+        TraceHeader header;
+        header.algorithm = algorithmName(alg);
+        header.input = a;
+        header.metadata.append({ "source", QFileInfo(job.input).fileName() });
+        if (!writer.open(job.tracePath, header)) {
+            job.error = writer.errorString();
+            return;
+        }
+        writer.addFrame(a, -1, -1, -1, {}, {});
+        probe.trace = &writer;
+    }
+
+    SortEngine::run(alg, a, probe, job.options);
+    job.comparisons = probe.comparisons;
+    job.steps = probe.steps;
+    job.peakDepth = probe.peakDepth;
+
+    if (probe.trace) {
+        std::vector<int> all(a.size());
+        for (size_t k = 0; k < all.size(); ++k) all[k] = static_cast<int>(k);
+        writer.addFrame(a, -1, -1, -1, all, {});
+        if (!writer.finish()) {
+            job.error = writer.errorString();
+            return;
+        }
+    }
+
+    if (!job.output.isEmpty()) writeNumbers(job.output, a, job.error);
+}
+
+// --merge: the inputs are sorted already and become one sorted file, merged in a single pass
+// however many there are.
+int runMerge(const QStringList& inputs, const QString& outPath, bool stats, QTextStream& out, QTextStream& err) {
+    std::vector<std::vector<int>> files(inputs.size());
+    for (int f = 0; f < inputs.size(); ++f) {
+        QString error;
+        if (!readNumbers(inputs[f], files[f], error)) {
+            err << inputs[f] << ": " << error << "\n";
+            return 1;
+        }
+        auto unsorted = std::is_sorted_until(files[f].begin(), files[f].end());
+        if (unsorted != files[f].end()) {
+            err << inputs[f] << ": not sorted (index " << (unsorted - files[f].begin()) << ")\n";
+            return 1;
+        }
+    }
+
+    std::vector<SortEngine::SortedRun> runs;
+    size_t total = 0;
+    for (const std::vector<int>& f : files) {
+        runs.push_back({ f.data(), f.data() + f.size() });
+        total += f.size();
+    }
+    std::vector<int> merged(total);
+    auto start = std::chrono::steady_clock::now();
+    SortEngine::mergeSortedRuns(runs, merged.data());
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    QString error;
+    if (!writeNumbers(outPath, merged, error)) {
+        err << outPath << ": " << error << "\n";
+        return 1;
+    }
+    if (stats) out << outPath << "\tmerged " << inputs.size() << " files\t" << total << " elements\t" << QString::number(ms, 'f', 3) << " ms\n";
+    return 0;
+}
+
+// With a single input 'path' names the file itself; with several it is a directory that
+// receives one file per input.
+QString outputPath(const QString& path, bool many, const QString& input, const QString& suffix) {
+    if (path.isEmpty() || !many) return path;
+    return QDir(path).filePath(QFileInfo(input).completeBaseName() + suffix);
+}
+
+} // namespace
+
+bool isHeadlessInvocation(int argc, char* argv[]) {
+    for (int k = 1; k < argc; ++k) {
+        if (std::strcmp(argv[k], "--headless") == 0) return true;
+    }
+    return false;
+}
+
+int runHeadless(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList keys;
+    for (SortAlgorithm alg : allAlgorithms()) keys << algorithmKey(alg);
+
+    QStringList distributions;
+    for (Distribution d : allDistributions()) distributions << distributionKey(d);
+
+    QStringList pivots;
+    for (PivotStrategy p : allPivotStrategies()) pivots << pivotStrategyKey(p);
+
+    QStringList gapKeys;
+    for (GapSequence g : allGapSequences()) gapKeys << gapSequenceKey(g);
+
+    QStringList heaps;
+    for (HeapVariant h : allHeapVariants()) heaps << heapVariantKey(h);
+
+    QStringList smalls;
+    for (SmallSort s : allSmallSorts()) smalls << smallSortKey(s);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Sorts files with the visualizer's engine, without a display.");
+    parser.addHelpOption();
+    parser.addOption({ "headless", "Run without the GUI." });
+    parser.addOption({ "algo", "Algorithm: " + keys.join(", ") + ", or auto to pick one per file.", "name", "quick" });
+    parser.addOption({ "input", "Input file; may be repeated. *.bin is raw int32, otherwise text.", "file" });
+    parser.addOption({ "pivot", "Pivot of the quick sorts: " + pivots.join(", ") + ", or all to compare them.", "strategy", "last" });
+    parser.addOption({ "gaps", "Gap sequence of shell sort: " + gapKeys.join(", ") + ", or all to compare them.", "sequence", "shell" });
+    parser.addOption({ "heap", "Heap of heap sort: " + heaps.join(", ") + ".", "variant", "binary" });
+    parser.addOption({ "cutoff", "Ranges shorter than n go to the small-range sort (quick, quick3, dualpivot, merge, radix); auto times the candidates first.", "n|auto", "0" });
+    parser.addOption({ "small", "Small-range sort below the cutoff: " + smalls.join(", ") + " (networks up to 32 elements, SIMD up to 64).", "kind", "insertion" });
+    parser.addOption({ "generate", "Sort a generated input instead of files: " + distributions.join(", ") + ".", "distribution" });
+    parser.addOption({ "size", "Number of elements to generate.", "n", "1000000" });
+    parser.addOption({ "seed", "Seed of the generated input; the same seed gives the same input.", "s", "1" });
+    parser.addOption({ "out", "Sorted output file, or a directory when there are several inputs.", "path" });
+    parser.addOption({ "trace", "Trace file (.strace) to record, or a directory when there are several inputs.", "path" });
+    parser.addOption({ "stats", "Print time, comparisons and writes for every file." });
+    parser.addOption({ "repeat", "Time every sort n times and report the best and the median.", "n", "1" });
+    parser.addOption({ "jobs", "Files sorted in parallel (default: one per core; use 1 for stable timings).", "n" });
+    parser.addOption({ "merge", "Merge the inputs, each sorted already, into the single --out file instead of sorting them." });
+    parser.addPositionalArgument("files", "More input files.", "[files...]");
+    parser.process(app);
+
+    SortAlgorithm alg = SortAlgorithm::Quick;
+    const QString algo = parser.value("algo").toLower();
+    const bool autoSelect = (algo == "auto");
+    if (!autoSelect && !algorithmFromKey(algo.toStdString(), alg)) {
+        err << "Unknown algorithm '" << parser.value("algo") << "'. Choose one of: " << keys.join(", ") << ", auto\n";
+        return 1;
+    }
+
+    std::vector<PivotStrategy> strategies;
+    if (parser.value("pivot").toLower() == "all") {
+        strategies = allPivotStrategies();
+    }
+    else {
+        PivotStrategy pivot;
+        if (!pivotStrategyFromKey(parser.value("pivot").toLower().toStdString(), pivot)) {
+            err << "Unknown pivot strategy '" << parser.value("pivot") << "'. Choose one of: " << pivots.join(", ") << ", all\n";
+            return 1;
+        }
+        strategies.push_back(pivot);
+    }
+
+    std::vector<GapSequence> gapSequences;
+    if (parser.value("gaps").toLower() == "all") {
+        gapSequences = allGapSequences();
+    }
+    else {
+        GapSequence gaps;
+        if (!gapSequenceFromKey(parser.value("gaps").toLower().toStdString(), gaps)) {
+            err << "Unknown gap sequence '" << parser.value("gaps") << "'. Choose one of: " << gapKeys.join(", ") << ", all\n";
+            return 1;
+        }
+        gapSequences.push_back(gaps);
+    }
+
+    SortOptions tuning;
+    if (!heapVariantFromKey(parser.value("heap").toLower().toStdString(), tuning.heap)) {
+        err << "Unknown heap '" << parser.value("heap") << "'. Choose one of: " << heaps.join(", ") << "\n";
+        return 1;
+    }
+    if (!smallSortFromKey(parser.value("small").toLower().toStdString(), tuning.smallSort)) {
+        err << "Unknown small-range sort '" << parser.value("small") << "'. Choose one of: " << smalls.join(", ") << "\n";
+        return 1;
+    }
+    const bool tuneCutoffs = parser.value("cutoff").toLower() == "auto";
+    if (!tuneCutoffs) {
+        bool ok = false;
+        tuning.cutoff = parser.value("cutoff").toInt(&ok);
+        if (!ok || tuning.cutoff < 0) {
+            err << "--cutoff must be a number of elements or auto.\n";
+            return 1;
+        }
+    }
+
+    QStringList inputs = parser.values("input") + parser.positionalArguments();
+    GeneratorOptions generator;
+    if (parser.isSet("generate")) {
+        if (!distributionFromKey(parser.value("generate").toLower().toStdString(), generator.distribution)) {
+            err << "Unknown distribution '" << parser.value("generate") << "'. Choose one of: " << distributions.join(", ") << "\n";
+            return 1;
+        }
+        generator.size = parser.value("size").toInt();
+        generator.seed = parser.value("seed").toULongLong();
+        if (generator.size < 1) {
+            err << "--size must be a positive number.\n";
+            return 1;
+        }
+        // named like a file so --out and --stats treat it as one
+        inputs << QString("%1-%2-seed%3").arg(distributionKey(generator.distribution)).arg(generator.size).arg(generator.seed);
+    }
+    if (inputs.isEmpty()) {
+        err << "No input files given.\n";
+        return 1;
+    }
+    if (parser.isSet("merge")) {
+        if (parser.isSet("generate") || parser.value("out").isEmpty()) {
+            err << "--merge takes sorted files and writes them to --out.\n";
+            return 1;
+        }
+        return runMerge(inputs, parser.value("out"), parser.isSet("stats"), out, err);
+    }
+
+    bool many = inputs.size() > 1;
+    QString outArg = parser.value("out");
+    QString traceArg = parser.value("trace");
+    for (const QString& dir : { outArg, traceArg }) {
+        if (many && !dir.isEmpty() && !QDir().mkpath(dir)) {
+            err << "Cannot create directory " << dir << "\n";
+            return 1;
+        }
+    }
+
+    // one job per input and per pivot strategy or gap sequence the algorithm reads; auto never
+    // picks Shell, and its pivot variants are dropped per input once the choice is known. Only
+    // the first variant writes the output and trace.
+    if (!autoSelect && !readsPivot(alg)) strategies.resize(1);
+    if (autoSelect || !readsGaps(alg)) gapSequences.resize(1);
+    std::vector<SortOptions> variants;
+    for (PivotStrategy pivot : strategies) {
+        for (GapSequence gaps : gapSequences) {
+            SortOptions options = tuning;
+            options.pivot = pivot;
+            options.gaps = gaps;
+            variants.push_back(options);
+        }
+    }
+    std::vector<Job> jobs;
+    for (const QString& input : inputs) {
+        for (size_t v = 0; v < variants.size(); ++v) {
+            Job job;
+            job.input = input;
+            job.options = variants[v];
+            if (v == 0) {
+                QString suffix = isBinary(job.input) ? ".sorted.bin" : ".sorted.txt";
+                job.output = outputPath(outArg, many, job.input, suffix);
+                job.tracePath = outputPath(traceArg, many, job.input, ".strace");
+            }
+            else {
+                job.pivotVariant = autoSelect;
+            }
+            jobs.push_back(job);
+        }
+    }
+    if (parser.isSet("generate")) {
+        std::vector<int> generated = generateInput(generator);
+        for (Job& job : jobs) {
+            if (job.input == inputs.back()) job.generated = generated;
+        }
+    }
+
+    // tuned before any sorting starts, so the timings do not compete with the jobs for the cores
+    std::map<SortAlgorithm, int> tuned;
+    if (tuneCutoffs) {
+        std::vector<SortAlgorithm> tunable = { alg };
+        if (autoSelect) tunable = { SortAlgorithm::Quick, SortAlgorithm::Quick3, SortAlgorithm::Merge, SortAlgorithm::Radix };
+        for (SortAlgorithm t : tunable) {
+            tuned[t] = tuneCutoff(t, variants.front());
+            err << "Tuned cutoff for " << algorithmKey(t) << ": " << tuned[t] << "\n";
+        }
+    }
+
+    const int repeats = std::max(1, parser.value("repeat").toInt());
+    const bool stats = parser.isSet("stats");
+
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (parser.isSet("jobs")) threads = parser.value("jobs").toInt();
+    threads = std::max(1, std::min(threads, static_cast<int>(jobs.size())));
+
+    // workers take the next unclaimed file until none are left
+    std::atomic<int> next{0};
+    auto worker = [&] {
+        for (int k = next.fetch_add(1); k < static_cast<int>(jobs.size()); k = next.fetch_add(1))
+            runJob(jobs[k], alg, autoSelect, tuneCutoffs ? &tuned : nullptr, repeats, stats);
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+
+    int failures = 0;
+    for (const Job& job : jobs) {
+        if (job.duplicate) continue;
+        if (!job.error.isEmpty()) {
+            err << job.input << ": " << job.error << "\n";
+            ++failures;
+            continue;
+        }
+        if (stats) {
+            out << job.input << "\t" << (autoSelect ? "auto:" : "") << algorithmKey(job.algorithm) << "\t" << job.elements << " elements\t"
+                << QString::number(job.bestMs, 'f', 3) << " ms";
+            if (repeats > 1) out << " (median " << QString::number(job.medianMs, 'f', 3) << " ms of " << repeats << ")";
+            out << "\t" << job.comparisons << " comparisons\t" << job.steps << " writes";
+            if (readsPivot(job.algorithm))
+                out << "\tpivot " << pivotStrategyKey(job.options.pivot) << ", peak stack " << job.peakDepth;
+            if (readsGaps(job.algorithm)) out << "\tgaps " << gapSequenceKey(job.options.gaps);
+            if (job.algorithm == SortAlgorithm::Heap) out << "\theap " << heapVariantKey(job.options.heap);
+            if (job.options.cutoff > 0)
+                out << "\tcutoff " << job.options.cutoff << " (" << smallSortKey(job.options.smallSort) << ")";
+            if (autoSelect) out << "\t" << job.reason;
+            out << "\n";
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
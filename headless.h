@@ -0,0 +1,10 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// Command-line mode: sorts files with the engine and never creates a widget, so it runs on
+// machines without a display. Entered when "--headless" is among the arguments, e.g.
+//   SortingAlgorithms --headless --algo quick --input data.bin --out sorted.bin --stats
+bool isHeadlessInvocation(int argc, char* argv[]);
+int runHeadless(int argc, char* argv[]);
+
+#endif // HEADLESS_H
@@ -0,0 +1,212 @@
+#include "inputgenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace {
+const int kChunk = 1 << 16;
+const int kFewUniqueValues = 8;
+const int kSawTeeth = 8;
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** (Blackman and Vigna): a few shifts, rotates and one multiply per 64 bits
+struct Xoshiro256 {
+    uint64_t s[4];
+
+    Xoshiro256(uint64_t seed, uint64_t stream) {
+        uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (uint64_t& w : s) w = splitmix64(x);
+    }
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t next() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+    // uniform in [0, range) for range <= 2^32, by multiply-shift instead of a division
+    uint32_t below(uint64_t range) { return static_cast<uint32_t>(((next() >> 32) * range) >> 32); }
+    double unit() { return (next() >> 11) * 0x1.0p-53; }
+};
+
+// Calls fill(rng, begin, end) for every chunk of a[0, n), chunks spread over the threads.
+template <typename Fill>
+void fillChunks(std::vector<int>& a, uint64_t seed, int threads, Fill fill) {
+    const int n = static_cast<int>(a.size());
+    const int chunks = (n + kChunk - 1) / kChunk;
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, chunks));
+
+    std::atomic<int> next{0};
+    auto worker = [&] {
+        for (int c = next.fetch_add(1); c < chunks; c = next.fetch_add(1)) {
+            Xoshiro256 rng(seed, static_cast<uint64_t>(c) + 1);
+            fill(rng, a.data() + static_cast<size_t>(c) * kChunk,
+                 c * static_cast<long long>(kChunk), std::min(n, (c + 1) * kChunk));
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+}
+
+// Values are in [1, range] and range is O(n), so counting beats comparison sorting by far.
+void countingSort(std::vector<int>& a, uint64_t range, bool descending) {
+    std::vector<int> count(range + 1, 0);
+    for (int v : a) ++count[v];
+    size_t k = 0;
+    for (uint64_t step = 0; step <= range; ++step) {
+        int v = static_cast<int>(descending ? range - step : step);
+        std::fill_n(a.begin() + k, count[v], v);
+        k += count[v];
+    }
+}
+}
+
+const char* distributionName(Distribution d) {
+    switch (d) {
+    case Distribution::Random:       return "Random";
+    case Distribution::Sorted:       return "Sorted";
+    case Distribution::Reversed:     return "Reversed";
+    case Distribution::NearlySorted: return "Nearly Sorted";
+    case Distribution::Uniform32:    return "Uniform 32-bit";
+    case Distribution::FewUnique:    return "Few Unique";
+    case Distribution::Zipf:         return "Zipf";
+    case Distribution::Sawtooth:     return "Sawtooth";
+    case Distribution::OrganPipe:    return "Organ Pipe";
+    case Distribution::AllEqual:     return "All Equal";
+    }
+    return "";
+}
+
+const char* distributionKey(Distribution d) {
+    switch (d) {
+    case Distribution::Random:       return "random";
+    case Distribution::Sorted:       return "sorted";
+    case Distribution::Reversed:     return "reversed";
+    case Distribution::NearlySorted: return "nearly";
+    case Distribution::Uniform32:    return "uniform32";
+    case Distribution::FewUnique:    return "few";
+    case Distribution::Zipf:         return "zipf";
+    case Distribution::Sawtooth:     return "sawtooth";
+    case Distribution::OrganPipe:    return "organpipe";
+    case Distribution::AllEqual:     return "equal";
+    }
+    return "";
+}
+
+const std::vector<Distribution>& allDistributions() {
+    static const std::vector<Distribution> all = {
+        Distribution::Random, Distribution::Sorted, Distribution::Reversed, Distribution::NearlySorted,
+        Distribution::Uniform32, Distribution::FewUnique, Distribution::Zipf, Distribution::Sawtooth,
+        Distribution::OrganPipe, Distribution::AllEqual
+    };
+    return all;
+}
+
+bool distributionFromName(const std::string& name, Distribution& out) {
+    for (Distribution d : allDistributions()) {
+        if (name == distributionName(d)) {
+            out = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool distributionFromKey(const std::string& key, Distribution& out) {
+    for (Distribution d : allDistributions()) {
+        if (key == distributionKey(d)) {
+            out = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> generateInput(const GeneratorOptions& options) {
+    const int n = std::max(0, options.size);
+    const uint64_t seed = options.seed;
+    const int threads = options.threads;
+    // small inputs keep the familiar 1..100 bars; larger ones get room for mostly distinct values
+    const uint64_t range = static_cast<uint64_t>(std::max(100, n));
+    std::vector<int> a(n);
+
+    switch (options.distribution) {
+    case Distribution::Random:
+    case Distribution::Sorted:
+    case Distribution::Reversed:
+    case Distribution::NearlySorted:
+        fillChunks(a, seed, threads, [range](Xoshiro256& rng, int* out, long long begin, long long end) {
+            for (long long k = begin; k < end; ++k) *out++ = 1 + static_cast<int>(rng.below(range));
+        });
+        break;
+    case Distribution::Uniform32:
+        fillChunks(a, seed, threads, [](Xoshiro256& rng, int* out, long long begin, long long end) {
+            for (long long k = begin; k < end; ++k) *out++ = static_cast<int>(static_cast<uint32_t>(rng.next() >> 32));
+        });
+        break;
+    case Distribution::FewUnique: {
+        Xoshiro256 pick(seed, 0);
+        int values[kFewUniqueValues];
+        for (int& v : values) v = 1 + static_cast<int>(pick.below(range));
+        fillChunks(a, seed, threads, [&values](Xoshiro256& rng, int* out, long long begin, long long end) {
+            for (long long k = begin; k < end; ++k) *out++ = values[rng.below(kFewUniqueValues)];
+        });
+        break;
+    }
+    case Distribution::Zipf: {
+        // inverse of the continuous s = 1 CDF, ln(x) / ln(range + 1): P(rank k) ~ 1/k
+        const double logRange = std::log(static_cast<double>(range) + 1);
+        fillChunks(a, seed, threads, [range, logRange](Xoshiro256& rng, int* out, long long begin, long long end) {
+            for (long long k = begin; k < end; ++k) {
+                uint64_t rank = static_cast<uint64_t>(std::exp(rng.unit() * logRange));
+                *out++ = static_cast<int>(std::max<uint64_t>(1, std::min(rank, range)));
+            }
+        });
+        break;
+    }
+    case Distribution::Sawtooth: {
+        const long long period = std::max(1, (n + kSawTeeth - 1) / kSawTeeth);
+        fillChunks(a, seed, threads, [period](Xoshiro256&, int* out, long long begin, long long end) {
+            for (long long k = begin; k < end; ++k) *out++ = static_cast<int>(k % period) + 1;
+        });
+        break;
+    }
+    case Distribution::OrganPipe:
+        fillChunks(a, seed, threads, [n](Xoshiro256&, int* out, long long begin, long long end) {
+            for (long long k = begin; k < end; ++k) *out++ = static_cast<int>(std::min(k, n - 1 - k)) + 1;
+        });
+        break;
+    case Distribution::AllEqual:
+        std::fill(a.begin(), a.end(), static_cast<int>(range / 2));
+        break;
+    }
+
+    if (options.distribution == Distribution::Sorted || options.distribution == Distribution::NearlySorted)
+        countingSort(a, range, false);
+    else if (options.distribution == Distribution::Reversed)
+        countingSort(a, range, true);
+
+    if (options.distribution == Distribution::NearlySorted && n > 1) {
+        // number of swaps = max(1, n * percent / 100), drawn from a stream of their own
+        Xoshiro256 rng(seed, ~0ull);
+        long long swaps = std::max(1LL, static_cast<long long>(n) * options.perturbPercent / 100);
+        for (long long s = 0; s < swaps; ++s) std::swap(a[rng.below(n)], a[rng.below(n)]);
+    }
+    return a;
+}
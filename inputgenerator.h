@@ -0,0 +1,39 @@
+#ifndef INPUTGENERATOR_H
+#define INPUTGENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class Distribution {
+    Random,        // uniform in [1, max(100, n)]
+    Sorted,
+    Reversed,
+    NearlySorted,  // sorted, then perturbPercent% of n random swaps
+    Uniform32,     // uniform over the whole int range, negatives included
+    FewUnique,     // 8 distinct values
+    Zipf,          // Zipf-like (s = 1) ranks: small values are far more frequent
+    Sawtooth,      // 8 ascending ramps
+    OrganPipe,     // ascending to the middle, then descending
+    AllEqual
+};
+
+const char* distributionName(Distribution d);   // "Nearly Sorted", as shown in the GUI
+const char* distributionKey(Distribution d);    // "nearly", as used on the command line
+const std::vector<Distribution>& allDistributions();
+bool distributionFromName(const std::string& name, Distribution& out);
+bool distributionFromKey(const std::string& key, Distribution& out);
+
+struct GeneratorOptions {
+    Distribution distribution = Distribution::Random;
+    int size = 20;
+    uint64_t seed = 1;
+    int perturbPercent = 10;  // NearlySorted only
+    int threads = 0;          // 0: one per core
+};
+
+// The same options always give the same array, whatever the thread count: the array is cut into
+// fixed-size chunks and every chunk has its own xoshiro256** stream derived from the seed.
+std::vector<int> generateInput(const GeneratorOptions& options);
+
+#endif // INPUTGENERATOR_H
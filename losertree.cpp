@@ -0,0 +1,82 @@
+#include "losertree.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace SortEngine {
+
+namespace {
+
+// A node is (exhausted, key, source) in one word: bit 63 is set once a source runs dry, bits 31 to
+// 62 hold the key with its sign bit flipped (so signed order becomes unsigned order) and bits 0
+// to 30 the source, which breaks ties and is read back out of the winner.
+const uint64_t kExhausted = uint64_t(1) << 63;
+const uint64_t kSourceMask = (uint64_t(1) << 31) - 1;
+
+inline uint64_t pack(int key, int source) {
+    return (uint64_t(static_cast<uint32_t>(key) ^ 0x80000000u) << 31) | static_cast<uint64_t>(source);
+}
+
+} // namespace
+
+void mergeSortedRuns(const std::vector<SortedRun>& runs, int* out) {
+    const int k = static_cast<int>(runs.size());
+    if (k == 0) return;
+    if (k == 1) {
+        std::copy(runs[0].first, runs[0].last, out);
+        return;
+    }
+
+    std::vector<const int*> pos(k), end(k);
+    long long total = 0;
+    for (int s = 0; s < k; ++s) {
+        pos[s] = runs[s].first;
+        end[s] = runs[s].last;
+        total += runs[s].last - runs[s].first;
+    }
+    auto head = [&](int s) { return pos[s] != end[s] ? pack(*pos[s], s) : kExhausted | static_cast<uint64_t>(s); };
+
+    std::vector<uint64_t> node(k);
+    std::vector<uint64_t> winner(2 * k);
+    for (int s = 0; s < k; ++s) winner[k + s] = head(s);
+    for (int i = k - 1; i > 0; --i) {
+        node[i] = std::max(winner[2 * i], winner[2 * i + 1]);
+        winner[i] = std::min(winner[2 * i], winner[2 * i + 1]);
+    }
+    uint64_t top = winner[1];
+
+    for (long long t = 0; t < total; ++t) {
+        const int s = static_cast<int>(top & kSourceMask);
+        *out++ = *pos[s]++;
+        uint64_t w = head(s);
+        for (int i = (k + s) / 2; i > 0; i /= 2) {
+            // swap when the stored loser wins this match; as a mask, since compilers turn
+            // min/max into a conditional store here, which mispredicts half the time
+            const uint64_t loser = node[i];
+            const uint64_t flip = (loser ^ w) & (uint64_t(0) - uint64_t(loser < w));
+            node[i] = loser ^ flip;
+            w ^= flip;
+        }
+        top = w;
+    }
+}
+
+void mergeRunPasses(int* a, int* scratch, long long n, long long width, int ways) {
+    int* from = a;
+    int* to = scratch;
+    std::vector<SortedRun> runs;
+    for (; width < n; width *= ways) {
+        const long long group = width * ways;
+        for (long long left = 0; left < n; left += group) {
+            runs.clear();
+            const long long right = std::min(left + group, n);
+            for (long long r = left; r < right; r += width) runs.push_back({ from + r, from + std::min(r + width, right) });
+            mergeSortedRuns(runs, to + left);
+        }
+        std::swap(from, to);
+    }
+    if (from != a) std::copy(from, from + n, a);
+}
+
+} // namespace SortEngine
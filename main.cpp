@@ -1,9 +1,14 @@
 #include "mainwindow.h"
+#include "headless.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    // checked before QApplication exists, which would need a display
+    if (isHeadlessInvocation(argc, argv))
+        return runHeadless(argc, argv);
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
@@ -3,7 +3,6 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 #include <QVBoxLayout>
-#include <QGraphicsRectItem>
 #include <QStringList>
 #include <QMessageBox>
 #include <QHBoxLayout>
@@ -13,6 +12,23 @@
 #include <QColor>
 #include <QString>
 #include <QStyleFactory>
+#include <QFileDialog>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QApplication>
+#include <QFileInfo>
+#include <QDir>
+#include <QInputDialog>
+#include <QProgressDialog>
+#include <QTemporaryDir>
+#include <cmath>
+#include <limits>
+
+#include "arraymetrics.h"
+#include "autoselect.h"
+#include "cutofftuner.h"
+#include "inputgenerator.h"
+#include "racewindow.h"
 
 
 /*
@@ -23,7 +39,7 @@
  */
 
 MainWindow::MainWindow(QWidget* parent)
-    : QMainWindow(parent), i(0), j(0), ui(new Ui::MainWindow)
+    : QMainWindow(parent), ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
 
@@ -38,7 +54,7 @@ MainWindow::MainWindow(QWidget* parent)
     QString modernTheme = R"(
     QMainWindow, QWidget { background-color: #1E1E1E; color: #DFDFDF; font-family: 'Segoe UI', sans-serif; font-size: 14px; }
 
-    QGraphicsView { background-color: #252526; border: 1px solid #3E3E42; border-radius: 8px; margin: 10px; }
+    ArrayView { background-color: #252526; border: 1px solid #3E3E42; border-radius: 8px; }
 
     QPushButton { background-color: #333337; color: #DFDFDF; border: 1px solid #454545; border-radius: 6px; padding: 8px 20px; font-weight: 600; }
     QPushButton:hover { background-color: #3E3E42; border: 1px solid #555555; }
@@ -119,18 +135,59 @@ MainWindow::MainWindow(QWidget* parent)
 
     //CORE WIDGET INITIALIZATION
     algorithmBox = new QComboBox();
-    algorithmBox->addItems({ "Bubble Sort", "Insertion Sort", "Selection Sort", "Quick Sort", "Merge Sort", "Heap Sort", "Shell Sort", "Tim Sort", "Radix Sort", "Gnome Sort" });
+    for (SortAlgorithm alg : allAlgorithms()) algorithmBox->addItem(algorithmName(alg));
+    algorithmBox->addItem("Auto");
+
+    pivotBox = new QComboBox();
+    for (PivotStrategy p : allPivotStrategies()) pivotBox->addItem(pivotStrategyName(p));
+    pivotBox->setToolTip("How the quick sorts choose their pivot");
+    pivotLabel = new QLabel("Pivot:");
+
+    heapBox = new QComboBox();
+    for (HeapVariant h : allHeapVariants()) heapBox->addItem(heapVariantName(h));
+    heapBox->setToolTip("Bottom-up heaps sift to a leaf first and save about half the comparisons; "
+                        "4- and 8-ary heaps are shallower and keep siblings in one cache line");
+    heapLabel = new QLabel("Heap:");
+
+    gapBox = new QComboBox();
+    for (GapSequence g : allGapSequences()) gapBox->addItem(gapSequenceName(g));
+    gapBox->setToolTip("Gaps of Shell Sort, largest first; Tokuda's and Ciura's need the fewest comparisons");
+    gapLabel = new QLabel("Gaps:");
+
+    cutoffSpinBox = new QSpinBox();
+    cutoffSpinBox->setRange(0, 64);
+    cutoffSpinBox->setValue(0);
+    cutoffSpinBox->setSpecialValueText("Off");
+    cutoffSpinBox->setToolTip("Ranges shorter than this stop recursing and are finished by the small-range sort");
+    smallSortBox = new QComboBox();
+    for (SmallSort s : allSmallSorts()) smallSortBox->addItem(smallSortName(s));
+    smallSortBox->setToolTip(QString("Sorting networks cover ranges of up to 32 elements, the SIMD kernel (%1 on this CPU) up to 64; "
+                                     "longer ones use insertion sort").arg(SortEngine::simdSortIsa()));
+    cutoffLabel = new QLabel("Cutoff:");
+    tuneCutoffButton = new QPushButton("Tune");
+    tuneCutoffButton->setToolTip("Time every candidate cutoff on this CPU and pick the fastest");
 
     startButton = new QPushButton("Start Sort");
     resetButton = new QPushButton("Reset to Default");
     randomButton = new QPushButton("Random Input");
+    raceButton = new QPushButton("Race Mode");
+    saveTraceButton = new QPushButton("Save Trace");
+    loadTraceButton = new QPushButton("Load Trace");
+    exportFramesButton = new QPushButton("Export Frames");
 
     sizeSpinBox = new QSpinBox();
+    // every step of a run is recorded with a copy of the array, so large sizes belong to --headless
     sizeSpinBox->setRange(2, 200);
     sizeSpinBox->setValue(20);
 
+    seedSpinBox = new QSpinBox();
+    seedSpinBox->setRange(0, std::numeric_limits<int>::max());
+    seedSpinBox->setValue(0);
+    seedSpinBox->setSpecialValueText("Random");
+    seedSpinBox->setToolTip("Same seed, size and distribution give the same input (Random = a new seed every time)");
+
     distributionBox = new QComboBox();
-    distributionBox->addItems({ "Random", "Sorted", "Reversed", "Nearly Sorted" });
+    for (Distribution d : allDistributions()) distributionBox->addItem(distributionName(d));
 
     algorithmBox->setView(new QListView());
     distributionBox->setView(new QListView());
@@ -150,12 +207,19 @@ MainWindow::MainWindow(QWidget* parent)
     delayBox->setRange(50, 2000);
     delayBox->setValue(500);
 
+    durationSpinBox = new QSpinBox();
+    durationSpinBox->setRange(0, 3600);
+    durationSpinBox->setValue(0);
+    durationSpinBox->setSuffix(" s");
+    durationSpinBox->setSpecialValueText("Off");
+    durationSpinBox->setToolTip("Finish the whole animation in this many seconds, skipping the least eventful steps");
+
     inputField = new QLineEdit();
     inputField->setText("58 12 91 7 34 76 25 63 89 3 47 68 20 99 14 55 81 39 6 72");
 
-    view = new QGraphicsView();
-    scene = new QGraphicsScene(this);
-    view->setScene(scene);
+    view = new ArrayView();
+    view->setValues(&array);
+    view->setColorFunction([this](int k) { return barColor(k); });
 
     stepLabel = new QLabel("Ready");
     logView = new QPlainTextEdit();
@@ -166,6 +230,9 @@ MainWindow::MainWindow(QWidget* parent)
 
     descriptionLabel = new QLabel("Bubble Sort - Simple but slow.");
     bigoDescriptionLabel = new QLabel("Best Case: O(n)\nAverage Case: O(n^2)\nWorst Case: O(n^2)");
+    metricsLabel = new QLabel();
+    metricsLabel->setToolTip("Measured on the current input. Insertion and Gnome sort shift once per inversion; "
+                             "Tim sort's merge work grows with log2 of the number of runs.");
 
     slider = new QSlider(Qt::Horizontal);
     pseudocodeView = new QListWidget();
@@ -181,14 +248,27 @@ MainWindow::MainWindow(QWidget* parent)
     QHBoxLayout* topToolbar = new QHBoxLayout();
     topToolbar->addWidget(new QLabel("Algorithm:"));
     topToolbar->addWidget(algorithmBox);
+    topToolbar->addWidget(pivotLabel);
+    topToolbar->addWidget(pivotBox);
+    topToolbar->addWidget(heapLabel);
+    topToolbar->addWidget(heapBox);
+    topToolbar->addWidget(gapLabel);
+    topToolbar->addWidget(gapBox);
+    topToolbar->addWidget(cutoffLabel);
+    topToolbar->addWidget(cutoffSpinBox);
+    topToolbar->addWidget(smallSortBox);
+    topToolbar->addWidget(tuneCutoffButton);
     topToolbar->addWidget(startButton);
     topToolbar->addWidget(randomButton);
     topToolbar->addWidget(resetButton);
+    topToolbar->addWidget(raceButton);
     topToolbar->addSpacing(15);
     topToolbar->addWidget(new QLabel("Size:"));
     topToolbar->addWidget(sizeSpinBox);
     topToolbar->addWidget(new QLabel("Distribution:"));
     topToolbar->addWidget(distributionBox);
+    topToolbar->addWidget(new QLabel("Seed:"));
+    topToolbar->addWidget(seedSpinBox);
     topToolbar->addWidget(new QLabel("Perturb:"));
     topToolbar->addWidget(nearlySortedSlider);
     topToolbar->addWidget(nearlySortedValueLabel);
@@ -199,6 +279,9 @@ MainWindow::MainWindow(QWidget* parent)
     QHBoxLayout* inputRow = new QHBoxLayout();
     inputRow->addWidget(new QLabel("Input Array:"));
     inputRow->addWidget(inputField);
+    inputRow->addWidget(saveTraceButton);
+    inputRow->addWidget(loadTraceButton);
+    inputRow->addWidget(exportFramesButton);
     mainLayout->addLayout(inputRow);
 
     QHBoxLayout* workspaceLayout = new QHBoxLayout();
@@ -208,6 +291,8 @@ MainWindow::MainWindow(QWidget* parent)
     QHBoxLayout* timelineRow = new QHBoxLayout();
     timelineRow->addWidget(new QLabel("Speed:"));
     timelineRow->addWidget(delayBox);
+    timelineRow->addWidget(new QLabel("Duration:"));
+    timelineRow->addWidget(durationSpinBox);
     timelineRow->addWidget(stepByStepCheck);
     timelineRow->addWidget(nextStepButton);
     timelineRow->addWidget(new QLabel("Scrub Timeline:"));
@@ -221,7 +306,10 @@ MainWindow::MainWindow(QWidget* parent)
     rightColumn->addWidget(pseudocodeView);
     pseudocodeView->setFixedWidth(420);
     rightColumn->addWidget(descriptionLabel);
-    rightColumn->addWidget(bigoDescriptionLabel);
+    QHBoxLayout* complexityRow = new QHBoxLayout();
+    complexityRow->addWidget(bigoDescriptionLabel);
+    complexityRow->addWidget(metricsLabel, 1);
+    rightColumn->addLayout(complexityRow);
     rightColumn->addWidget(new QLabel("Execution Log"));
     rightColumn->addWidget(logView);
     rightColumn->addWidget(legendTitleLabel);
@@ -235,6 +323,8 @@ MainWindow::MainWindow(QWidget* parent)
     //  CONNECTIONS
 
     timer = new QTimer(this);
+    playbackTimer = new QTimer(this);
+    connect(playbackTimer, &QTimer::timeout, this, &MainWindow::onPlaybackTick);
     connect(startButton, &QPushButton::clicked, this, &MainWindow::onStartClicked);
     connect(timer, &QTimer::timeout, this, &MainWindow::onTimerTick);
     connect(resetButton, &QPushButton::clicked, this, &MainWindow::onResetClicked);
@@ -256,8 +346,27 @@ MainWindow::MainWindow(QWidget* parent)
 
 
     connect(randomButton, &QPushButton::clicked, this, &MainWindow::onRandomClicked);
+    connect(raceButton, &QPushButton::clicked, this, &MainWindow::onRaceClicked);
+    connect(saveTraceButton, &QPushButton::clicked, this, &MainWindow::onSaveTraceClicked);
+    connect(loadTraceButton, &QPushButton::clicked, this, &MainWindow::onLoadTraceClicked);
+    connect(exportFramesButton, &QPushButton::clicked, this, &MainWindow::onExportFramesClicked);
+    connect(tuneCutoffButton, &QPushButton::clicked, this, &MainWindow::onTuneCutoffClicked);
+    // the legend and pseudocode show the small-range step only while a cutoff is set
+    connect(cutoffSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this] {
+        onAlgorithmSelected(algorithmBox->currentText());
+    });
+    connect(smallSortBox, &QComboBox::currentTextChanged, this, [this] {
+        onAlgorithmSelected(algorithmBox->currentText());
+    });
+    connect(heapBox, &QComboBox::currentTextChanged, this, [this] {
+        onAlgorithmSelected(algorithmBox->currentText());
+    });
+    connect(gapBox, &QComboBox::currentTextChanged, this, [this] {
+        onAlgorithmSelected(algorithmBox->currentText());
+    });
     connect(distributionBox, &QComboBox::currentTextChanged, this, &MainWindow::onControlsChanged);
     connect(sizeSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onControlsChanged);
+    connect(seedSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onControlsChanged);
     connect(nearlySortedSlider, &QSlider::valueChanged, this, [&](int v){
         nearlySortedValueLabel->setText(QString::number(v) + " %");
 
@@ -289,7 +398,7 @@ void MainWindow::setPseudocode(const QStringList& lines) {
 }
 
 void MainWindow::highlightPseudocodeLine(int index) {
-    if (!pseudocodeView) return;
+    if (!pseudocodeView || recordingOnly) return;
 
     // Reset old styles
     for (int r = 0; r < pseudocodeView->count(); ++r) {
@@ -318,6 +427,21 @@ void MainWindow::highlightPseudocodeLine(int index) {
     pseudocodeCurrent = index;
 }
 
+void MainWindow::updateMetrics(const std::vector<int>& input) {
+    if (input.size() < 2) {
+        metricsLabel->clear();
+        return;
+    }
+    ArrayMetrics m = computeArrayMetrics(input);
+    // Tim sort merges the natural runs; a single run is a plain scan
+    double timWork = m.n * std::max(1.0, std::log2(static_cast<double>(m.runs)));
+    metricsLabel->setText(QString("Inversions: %1 (%2% of max) | Runs: %3\nLongest increasing: %4 | Distinct: %5\n"
+                                  "Insertion/Gnome: ~%6 shifts | Tim: ~%7 merge comparisons")
+                              .arg(m.inversions).arg(100 * m.disorder(), 0, 'f', 1).arg(m.runs)
+                              .arg(m.longestIncreasing).arg(m.distinct)
+                              .arg(m.inversions).arg(timWork, 0, 'f', 0));
+}
+
 static QString complexityText(MainWindow::SortAlgorithm alg) {
     switch (alg) {
         case MainWindow::SortAlgorithm::Bubble:
@@ -328,18 +452,31 @@ static QString complexityText(MainWindow::SortAlgorithm alg) {
             return "Best Case: O(n^2)\nAverage Case: O(n^2)\nWorst Case: O(n^2)";
         case MainWindow::SortAlgorithm::Merge:
             return "Best Case: O(n log n)\nAverage Case: O(n log n)\nWorst Case: O(n log n)";
+        case MainWindow::SortAlgorithm::BlockMerge:
+            return "Best Case: O(n)\nAverage Case: O(n log n)\nWorst Case: O(n log n) comparisons, O(n log^2 n) moves";
         case MainWindow::SortAlgorithm::Quick:
             return "Best Case: O(n log n)\nAverage Case: O(n log n)\nWorst Case: O(n^2)";
+        case MainWindow::SortAlgorithm::Quick3:
+        case MainWindow::SortAlgorithm::DualPivot:
+            return "Best Case: O(n)\nAverage Case: O(n log n)\nWorst Case: O(n^2)";
         case MainWindow::SortAlgorithm::Heap:
             return "Best Case: O(n log n)\nAverage Case: O(n log n)\nWorst Case: O(n log n)";
         case MainWindow::SortAlgorithm::Shell:
             return "Best Case: O(n log n)\nAverage Case: O(n (log n)^2)\nWorst Case: O(n^2)";
         case MainWindow::SortAlgorithm::Tim:
+        case MainWindow::SortAlgorithm::NaturalMerge:
             return "Best Case: O(n)\nAverage Case: O(n log n)\nWorst Case: O(n log n)";
         case MainWindow::SortAlgorithm::Radix:
             return "Best Case: O(nk)\nAverage Case: O(nk)\nWorst Case: O(nk)";
         case MainWindow::SortAlgorithm::Gnome:
             return "Best Case: O(n)\nAverage Case: O(n^2)\nWorst Case: O(n^2)";
+        case MainWindow::SortAlgorithm::Network:
+        case MainWindow::SortAlgorithm::Bitonic:
+            return "Best Case: O(n (log n)^2)\nAverage Case: O(n (log n)^2)\nWorst Case: O(n (log n)^2)";
+        case MainWindow::SortAlgorithm::Counting:
+            return "Best Case: O(n + k)\nAverage Case: O(n + k)\nWorst Case: O(n + k), radix beyond k = min(2^22, max(2n, 4096))";
+        case MainWindow::SortAlgorithm::Bucket:
+            return "Best Case: O(n)\nAverage Case: O(n)\nWorst Case: O(n log k)";
         default:
             return "";
     }
@@ -397,7 +534,6 @@ void MainWindow::setDarkMode(bool enabled) {
 
     // redraw bars with new default color
     drawArray(array);
-    scene->update();
 }
 
 
@@ -433,6 +569,14 @@ void MainWindow::onAlgorithmSelected(const QString& selected) {
 
     pseudocodeView->clear();
 
+    bool quick = (selected == "Quick Sort" || selected == "3-Way Quick Sort" || selected == "Dual-Pivot Quick Sort");
+    pivotLabel->setVisible(quick);
+    pivotBox->setVisible(quick);
+    heapLabel->setVisible(selected == "Heap Sort");
+    heapBox->setVisible(selected == "Heap Sort");
+    gapLabel->setVisible(selected == "Shell Sort");
+    gapBox->setVisible(selected == "Shell Sort");
+
     if (selected == "Bubble Sort") {
         legendTitleLabel->setText("Legend — Bubble Sort");
         legendLayout->addWidget(makeLegendItem("crimson", "Comparison"));
@@ -485,13 +629,55 @@ void MainWindow::onAlgorithmSelected(const QString& selected) {
         bigoDescriptionLabel->setText("Best: O(n log n) | Avg: O(n log n) | Worst: O(n^2)");
         setPseudocode({
             "partition(A, low, high):",
-            "  pivot = A[high]",
+            "  pivot = choosePivot(A, low, high), swapped to A[high]",
             "  i = low - 1",
             "  for j = low to high-1:",
             "    if A[j] < pivot: swap(A[++i], A[j])",
             "  swap(A[i+1], A[high])"
         });
     }
+    else if (selected == "3-Way Quick Sort") {
+        legendTitleLabel->setText("Legend — 3-Way Quick Sort");
+        legendLayout->addWidget(makeLegendItem("dodgerblue", "Current"));
+        legendLayout->addWidget(makeLegendItem("gold", "Equal to pivot"));
+        legendLayout->addWidget(makeLegendItem("orange", "Greater boundary"));
+        legendLayout->addWidget(makeLegendItem("green", "Sorted"));
+        descriptionLabel->setText("3-Way Quick Sort - Splits into <, == and > pivot; equal keys are done in one pass.");
+        bigoDescriptionLabel->setText("Best: O(n) | Avg: O(n log n) | Worst: O(n^2)");
+        setPseudocode({
+            "partition(A, l, r), v = choosePivot(A, l, r), swapped to A[r]:",
+            "  lt = l, i = l, gt = r",
+            "  while i <= gt:",
+            "    if A[i] < v: swap(A[lt++], A[i++])",
+            "    elif A[i] > v: swap(A[i], A[gt--])",
+            "    else: i++",
+            "  A[lt..gt] == v is final; sort A[l..lt-1], A[gt+1..r]"
+        });
+    }
+    else if (selected == "Dual-Pivot Quick Sort") {
+        legendTitleLabel->setText("Legend — Dual-Pivot Quick Sort");
+        legendLayout->addWidget(makeLegendItem("mediumorchid", "Pivots p <= q"));
+        legendLayout->addWidget(makeLegendItem("lightskyblue", "< p (== p when gathering)"));
+        legendLayout->addWidget(makeLegendItem("gold", "Between the pivots"));
+        legendLayout->addWidget(makeLegendItem("hotpink", "> q (== q when gathering)"));
+        legendLayout->addWidget(makeLegendItem("crimson", "Current"));
+        legendLayout->addWidget(makeLegendItem("green", "Sorted"));
+        descriptionLabel->setText("Dual-Pivot Quick Sort - Two pivots split each range into three parts in one pass (Yaroslavskiy, as in the JDK).");
+        bigoDescriptionLabel->setText("Best: O(n) | Avg: O(n log n), ~35% fewer passes | Worst: O(n^2)");
+        setPseudocode({
+            "partition(A, l, r), p <= q = choosePivots(A, l, r), moved to A[l], A[r]:",
+            "  lt = l+1, k = l+1, gt = r-1",
+            "  while k <= gt:",
+            "    if A[k] < p: swap(A[k], A[lt++])",
+            "    elif A[k] > q:",
+            "      while A[gt] > q and k < gt: gt--",
+            "      swap(A[k], A[gt--]); if A[k] < p: swap(A[k], A[lt++])",
+            "    k++",
+            "  swap(A[l], A[--lt]), swap(A[r], A[++gt])",
+            "  if the middle is large: same loop with ==, gathering keys equal to p and q",
+            "  sort A[l..lt-1], A[lt+1..gt-1], A[gt+1..r]"
+        });
+    }
     else if (selected == "Merge Sort") {
         legendTitleLabel->setText("Legend — Merge Sort");
         legendLayout->addWidget(makeLegendItem("cyan", "Left"));
@@ -513,46 +699,115 @@ void MainWindow::onAlgorithmSelected(const QString& selected) {
         legendLayout->addWidget(makeLegendItem("orange", "Heapify"));
         legendLayout->addWidget(makeLegendItem("red", "Swap"));
         legendLayout->addWidget(makeLegendItem("green", "Sorted"));
-        descriptionLabel->setText("Heap Sort - Uses a binary heap data structure.");
         bigoDescriptionLabel->setText("Best: O(n log n) | Avg: O(n log n) | Worst: O(n log n)");
-        setPseudocode({
-            "buildMaxHeap(A):",
-            "  for i = n/2-1 down to 0: heapify(A, n, i)",
-            "extractAndSort(A):",
-            "  for i = n-1 down to 1:",
-            "    swap(A[0], A[i]), heapify(A, i, 0)"
-        });
+        const HeapVariant heap = currentSortOptions().heap;
+        if (heap == HeapVariant::Binary) {
+            descriptionLabel->setText("Heap Sort - Uses a binary heap data structure.");
+            setPseudocode({
+                "buildMaxHeap(A):",
+                "  for i = n/2-1 down to 0: heapify(A, n, i)",
+                "extractAndSort(A):",
+                "  for i = n-1 down to 1:",
+                "    swap(A[0], A[i]), heapify(A, i, 0)"
+            });
+        }
+        else {
+            const int d = heap == HeapVariant::EightAry ? 8 : heap == HeapVariant::FourAry ? 4 : 2;
+            descriptionLabel->setText(QString("Heap Sort - %1-ary heap, sifted bottom-up: down to a leaf along the largest "
+                                              "children, then back up to where the key belongs.").arg(d));
+            setPseudocode({
+                "buildMaxHeap(A):",
+                QString("  for i = (n-2)/%1 down to 0: siftBottomUp(A, n, i)").arg(d),
+                "extractAndSort(A):",
+                "  for i = n-1 down to 1:",
+                "    swap(A[0], A[i]), siftBottomUp(A, i, 0)"
+            });
+        }
     }
     else if (selected == "Shell Sort") {
         legendTitleLabel->setText("Legend — Shell Sort");
         legendLayout->addWidget(makeLegendItem("royalblue", "Key"));
         legendLayout->addWidget(makeLegendItem("orange", "Gap"));
         legendLayout->addWidget(makeLegendItem("green", "Sorted"));
-        descriptionLabel->setText("Shell Sort - Optimized Insertion Sort using gaps.");
-        bigoDescriptionLabel->setText("Best: O(n log n) | Avg: O(n^1.5) | Worst: O(n^2)");
+        const GapSequence gaps = currentSortOptions().gaps;
+        descriptionLabel->setText(QString("Shell Sort - Optimized Insertion Sort using gaps: %1.").arg(gapSequenceName(gaps)));
+        switch (gaps) {
+        case GapSequence::Shell:     bigoDescriptionLabel->setText("Best: O(n log n) | Avg: O(n^1.5) | Worst: O(n^2)"); break;
+        case GapSequence::Knuth:     bigoDescriptionLabel->setText("Best: O(n log n) | Avg: O(n^1.25) | Worst: O(n^1.5)"); break;
+        case GapSequence::Sedgewick: bigoDescriptionLabel->setText("Best: O(n log n) | Avg: O(n^7/6) | Worst: O(n^4/3)"); break;
+        case GapSequence::Tokuda:
+        case GapSequence::Ciura:     bigoDescriptionLabel->setText("Best: O(n log n) | Avg: unknown, fastest measured | Worst: unknown"); break;
+        }
+        const char* formula = gaps == GapSequence::Shell     ? "n/2, n/4, ..., 1"
+                            : gaps == GapSequence::Knuth     ? "(3^k-1)/2 below n/3, ..., 13, 4, 1"
+                            : gaps == GapSequence::Sedgewick ? "4^k + 3*2^(k-1) + 1 below n, ..., 8, 1"
+                            : gaps == GapSequence::Tokuda    ? "ceil(h_k), h_k = 2.25*h_(k-1) + 1, below n, ..., 4, 1"
+                                                             : "1750*2.25^k below n, ..., 1750, 701, ..., 4, 1";
         setPseudocode({
-            "gap = n/2",
-            "while gap > 0:",
+            QString("gaps = %1").arg(formula),
+            "for gap in gaps:",
             "  for i = gap to n-1:",
             "    temp = A[i], j = i",
             "    while j >= gap and A[j-gap] > temp:",
             "      A[j] = A[j-gap], j -= gap",
             "    A[j] = temp",
-            "  gap /= 2"
+            "  next gap"
+        });
+    }
+    else if (selected == "Block Merge Sort") {
+        legendTitleLabel->setText("Legend — Block Merge Sort");
+        legendLayout->addWidget(makeLegendItem("royalblue", "Insertion"));
+        legendLayout->addWidget(makeLegendItem("gold", "Block rotating right"));
+        legendLayout->addWidget(makeLegendItem("darkorange", "Block rotating left"));
+        legendLayout->addWidget(makeLegendItem("cyan", "Left"));
+        legendLayout->addWidget(makeLegendItem("deeppink", "Right"));
+        legendLayout->addWidget(makeLegendItem("crimson", "Current"));
+        legendLayout->addWidget(makeLegendItem("green", "Sorted"));
+        descriptionLabel->setText("Block Merge Sort - Stable merge sort with a sqrt(n) buffer instead of n: merges too big for it are split by block rotations.");
+        bigoDescriptionLabel->setText("Best: O(n) | Avg: O(n log n) | Worst: O(n log^2 n) moves | Memory: O(sqrt n)");
+        setPseudocode({
+            "cut into runs of 16 and insertion-sort each",
+            "for width = 16, 32, ...: merge neighbouring runs [l, m) and [m, r):",
+            "  if A[m-1] <= A[m]: already in order",
+            "  if the shorter run fits the sqrt(n) buffer: copy it out, merge it back",
+            "  else: cut the longer run in half, binary-search that key in the other",
+            "    rotate the two inner blocks past each other (three reversals)",
+            "    merge both smaller pairs the same way"
+        });
+    }
+    else if (selected == "Natural Merge Sort") {
+        legendTitleLabel->setText("Legend — Natural Merge Sort");
+        legendLayout->addWidget(makeLegendItem("gold", "Run found"));
+        legendLayout->addWidget(makeLegendItem("royalblue", "Insertion"));
+        legendLayout->addWidget(makeLegendItem("cyan", "Left run"));
+        legendLayout->addWidget(makeLegendItem("deeppink", "Right run"));
+        legendLayout->addWidget(makeLegendItem("crimson", "Current"));
+        legendLayout->addWidget(makeLegendItem("green", "Merged"));
+        descriptionLabel->setText("Natural Merge Sort - Finds the runs the input already has and merges them bottom-up, galloping where they barely overlap.");
+        bigoDescriptionLabel->setText("Best: O(n) | Avg: O(n log n) | Worst: O(n log n) | r runs: O(n log r)");
+        setPseudocode({
+            "scan for the next run: non-descending, or non-ascending",
+            "  reverse a non-ascending run (equal keys keep their order)",
+            "  extend a run shorter than 16 by insertion sort",
+            "while more than one run: merge neighbouring runs [l, m), [m, r) in pairs",
+            "  if A[m-1] <= A[m]: already in order",
+            "  skip the keys already in place at both ends (binary search)",
+            "  merge the rest, galloping once one side wins 7 times in a row"
         });
     }
     else if (selected == "Tim Sort") {
         legendTitleLabel->setText("Legend — Tim Sort");
         legendLayout->addWidget(makeLegendItem("royalblue", "Insertion"));
         legendLayout->addWidget(makeLegendItem("orange", "Merge"));
+        legendLayout->addWidget(makeLegendItem("lightsteelblue", "Runs being merged"));
         legendLayout->addWidget(makeLegendItem("green", "Sorted"));
-        descriptionLabel->setText("Tim Sort - Hybrid of Merge and Insertion sort.");
+        descriptionLabel->setText("Tim Sort - Hybrid of Merge and Insertion sort; a loser tree merges up to 32 runs in one pass.");
         bigoDescriptionLabel->setText("Best: O(n) | Avg: O(n log n) | Worst: O(n log n)");
         setPseudocode({
-            "1. Identify small runs (size 32-64)",
+            "1. Cut the input into runs of 32",
             "2. Sort each run with Insertion Sort",
-            "3. Merge runs using Merge Sort logic",
-            "4. Adaptive: use Galloping mode for speed"
+            "3. Merge up to 32 runs at once: the loser tree replays one path per element",
+            "4. Repeat until a single run is left"
         });
     }
     else if (selected == "Radix Sort") {
@@ -586,6 +841,100 @@ void MainWindow::onAlgorithmSelected(const QString& selected) {
         });
     }
 
+    else if (selected == "Sorting Network") {
+        legendTitleLabel->setText("Legend — Sorting Network");
+        legendLayout->addWidget(makeLegendItem("crimson", "Compare-exchange"));
+        legendLayout->addWidget(makeLegendItem("orange", "Current layer"));
+        legendLayout->addWidget(makeLegendItem("green", "Sorted"));
+        descriptionLabel->setText("Sorting Network - A fixed sequence of compare-exchanges, the same for every input of a size.");
+        bigoDescriptionLabel->setText("Best: O(n log^2 n) | Avg: O(n log^2 n) | Worst: O(n log^2 n)");
+        setPseudocode({
+            "comparators = optimal (n <= 8) or Batcher merge exchange",
+            "for each layer:",
+            "  for each comparator (i, j) in the layer:",
+            "    if A[j] < A[i]:",
+            "      swap(A[i], A[j])"
+        });
+    }
+    else if (selected == "Bitonic Sort") {
+        legendTitleLabel->setText("Legend — Bitonic Sort");
+        legendLayout->addWidget(makeLegendItem("crimson", "Compare-exchange"));
+        legendLayout->addWidget(makeLegendItem("lightsteelblue", "Lower half of a pair span"));
+        legendLayout->addWidget(makeLegendItem("plum", "Upper half of a pair span"));
+        legendLayout->addWidget(makeLegendItem("green", "Sorted"));
+        descriptionLabel->setText("Bitonic Sort - Data-independent merge network; every stage's compare-exchanges could run at once.");
+        bigoDescriptionLabel->setText("Best: O(n log^2 n) | Avg: O(n log^2 n) | Worst: O(n log^2 n)");
+        setPseudocode({
+            "for k = 2, 4, 8, ... while k/2 < n:",
+            "  compare-exchange each i with its mirror in its k-block",
+            "  for d = k/4, k/8, ..., 1:",
+            "    compare-exchange each i with i + d",
+            "  (smaller value first; pairs past n are skipped)"
+        });
+    }
+    else if (selected == "Counting Sort") {
+        legendTitleLabel->setText("Legend — Counting Sort");
+        legendLayout->addWidget(makeLegendItem("royalblue", "Counting"));
+        legendLayout->addWidget(makeLegendItem("green", "Written out"));
+        descriptionLabel->setText("Counting Sort - Counts every key of a small range, then writes each out as often as it occurred.");
+        bigoDescriptionLabel->setText("Best: O(n + k) | Avg: O(n + k) | Worst: O(n + k), k = key range");
+        setPseudocode({
+            "k = max - min + 1; if k > min(2^22, max(2n, 4096)): Radix Sort instead",
+            "for each x in A: count[x - min]++",
+            "i = 0",
+            "for v = 0 to k-1: write min + v count[v] times"
+        });
+    }
+    else if (selected == "Bucket Sort") {
+        legendTitleLabel->setText("Legend — Bucket Sort");
+        legendLayout->addWidget(makeLegendItem("royalblue", "Counting"));
+        legendLayout->addWidget(makeLegendItem("orange", "Bucketing / insertion"));
+        legendLayout->addWidget(makeLegendItem("green", "Sorted"));
+        descriptionLabel->setText("Bucket Sort - Scatters keys into ordered buckets by their top bits, then sorts each small bucket.");
+        bigoDescriptionLabel->setText("Best: O(n) | Avg: O(n) | Worst: O(n log k), k = key range");
+        setPseudocode({
+            "B = about n/16 buckets, shift = bits of (max - min) beyond B",
+            "for each x in A: size[(x - min) >> shift]++",
+            "start = prefix sums of size",
+            "scatter every x to its bucket, in order",
+            "sort buckets <= 64 directly, split larger ones again by their next bits"
+        });
+    }
+    else if (selected == "Auto") {
+        legendTitleLabel->setText("Legend — Auto");
+        legendLayout->addWidget(makeLegendItem("green", "Sorted"));
+        descriptionLabel->setText("Auto - Measures how ordered the input is, then runs the algorithm expected to be fastest.");
+        bigoDescriptionLabel->setText("Probe: O(n) | Sort: that of the chosen algorithm");
+        setPseudocode({
+            "measure runs, sampled inversions, duplicates, key range k",
+            "if n <= 32, several runs and > n sampled inversions: Sorting Network",
+            "else if one run or <= 4n exact inversions: Insertion Sort",
+            "else if <= 4n sampled inversions (but more exact ones): Natural Merge Sort",
+            "else if k <= min(2^22, max(2n, 4096)): Counting Sort",
+            "else if 2 * decimal digits of k < log2 n: Radix Sort",
+            "else if runs < n/8 or sampled inversions < 25% or > 75%: Natural Merge Sort",
+            "else if > 5% duplicate keys: 3-Way Quick Sort",
+            "else: Quick Sort"
+        });
+    }
+
+    bool cutoffApplies = quick || selected == "Merge Sort" || selected == "Radix Sort";
+    cutoffLabel->setVisible(cutoffApplies);
+    cutoffSpinBox->setVisible(cutoffApplies);
+    smallSortBox->setVisible(cutoffApplies);
+    tuneCutoffButton->setVisible(cutoffApplies);
+    if (cutoffApplies && cutoffSpinBox->value() > 0) {
+        // last pseudocode line; pseudocodeLine() points there while a small range is finished
+        legendLayout->addWidget(makeLegendItem("teal", "Below cutoff"));
+        const SmallSort small = currentSortOptions().smallSort;
+        QListWidgetItem* it = new QListWidgetItem(QString("if size < %1: %2").arg(cutoffSpinBox->value())
+                                                      .arg(small == SmallSort::Simd      ? "SIMD network (up to 64) or insertion sort"
+                                                           : small == SmallSort::Network ? "sorting network (up to 32) or insertion sort"
+                                                                                         : "insertion sort"));
+        it->setFlags(it->flags() & ~Qt::ItemIsSelectable);
+        pseudocodeView->addItem(it);
+    }
+
     legendLayout->activate();
     legendLayout->parentWidget()->setUpdatesEnabled(true);
     legendLayout->parentWidget()->update();
@@ -595,6 +944,26 @@ void MainWindow::onRandomClicked() {
     generateArrayFromControls(true);
 }
 
+void MainWindow::onRaceClicked() {
+    std::vector<int> input;
+    QStringList numberStrings = inputField->text().split(" ", Qt::SkipEmptyParts);
+    for (const QString& numStr : numberStrings) {
+        bool ok;
+        int num = numStr.toInt(&ok);
+        if (ok) input.push_back(num);
+    }
+
+    if (input.size() < 2) {
+        QMessageBox::warning(this, "Input Error", "Please enter at least two numbers to race on.");
+        return;
+    }
+
+    // every algorithm gets its own copy of the same input
+    RaceWindow* race = new RaceWindow(input, this);
+    race->setAttribute(Qt::WA_DeleteOnClose);
+    race->show();
+}
+
 void MainWindow::onControlsChanged() {
     bool isNearly = (distributionBox && distributionBox->currentText() == "Nearly Sorted");
     if (nearlySortedSlider) {
@@ -610,163 +979,134 @@ void MainWindow::onControlsChanged() {
 }
 
 void MainWindow::generateArrayFromControls(bool log) {
-    array.clear();
     displayedSortedIndices.clear();
     QStringList numbers;
 
-    int sz = 20;
-    if (sizeSpinBox) sz = sizeSpinBox->value();
-    QString dist = "Random";
-    if (distributionBox) dist = distributionBox->currentText();
-
-    // First generate a base random array
-    array.reserve(sz);
-    for (int k = 0; k < sz; ++k) {
-        int v = QRandomGenerator::global()->bounded(1, 101);
-        array.push_back(v);
-    }
-
-    // Apply distribution
-    if (dist == "Sorted") {
-        std::sort(array.begin(), array.end());
-    }
-    else if (dist == "Reversed") {
-        std::sort(array.begin(), array.end(), std::greater<int>());
-    }
-    else if (dist == "Nearly Sorted") {
-        std::sort(array.begin(), array.end());
-        int percent = 10;
-        if (nearlySortedSlider) percent = nearlySortedSlider->value();
-        // number of swaps to perform = max(1, floor(sz * percent / 100))
-        int swaps = std::max(1, (sz * percent) / 100);
-        for (int s = 0; s < swaps; ++s) {
-            int a = QRandomGenerator::global()->bounded(0, sz);
-            int b = QRandomGenerator::global()->bounded(0, sz);
-            if (a == b) continue;
-            std::swap(array[a], array[b]);
-        }
-    }
+    GeneratorOptions options;
+    if (sizeSpinBox) options.size = sizeSpinBox->value();
+    if (distributionBox) distributionFromName(distributionBox->currentText().toStdString(), options.distribution);
+    if (nearlySortedSlider) options.perturbPercent = nearlySortedSlider->value();
+    // a fixed seed reproduces the input; otherwise draw one and log it so the run can be repeated
+    options.seed = seedSpinBox && seedSpinBox->value() > 0 ? static_cast<uint64_t>(seedSpinBox->value())
+                                                           : QRandomGenerator::global()->bounded(1, std::numeric_limits<int>::max());
+    array = generateInput(options);
 
     for (int v : array) numbers << QString::number(v);
     inputField->setText(numbers.join(" "));
-    scene->clear();
     drawArray(array);
+    updateMetrics(array);
 
-    if (log) appendLog(QString("Generated %1 input (%2): %3").arg(sz).arg(dist).arg(inputField->text()));
+    if (log) {
+        QString summary = QString("Generated %1 input (%2, seed %3)").arg(options.size)
+                              .arg(distributionName(options.distribution)).arg(options.seed);
+        appendLog(array.size() <= 200 ? summary + ": " + inputField->text() : summary + ".");
+    }
 }
 
 void MainWindow::onSliderMoved(int value) {
-    if (value < 0 || value >= static_cast<int>(history.size())) return;
-
-    array = history[value];
-    drawArray(array);
-    currentStep = value;
-
-    displayedSortedIndices.clear();
-    if (value < static_cast<int>(sortedIndicesHistory.size())) {
-        displayedSortedIndices = sortedIndicesHistory[value];
-    }
-    else if (!history.empty()) {
-        const std::vector<int>& finalArr = history.back();
-        if (value < static_cast<int>(history.size())) {
-            for (int idx = 0; idx < static_cast<int>(array.size()) && idx < static_cast<int>(finalArr.size()); ++idx) {
-                if (array[idx] == finalArr[idx]) displayedSortedIndices.insert(idx);
-            }
-        }
-    }
-
-    if (value < static_cast<int>(radixPhaseHistory.size())) radixPhase = radixPhaseHistory[value];
-    if (value < static_cast<int>(radixIndexHistory.size())) radixIndex = radixIndexHistory[value];
-    // Restore shell per-frame state
-    if (value < static_cast<int>(shellIHistory.size())) shellI = shellIHistory[value];
-    if (value < static_cast<int>(shellJHistory.size())) shellJ = shellJHistory[value];
-    if (value < static_cast<int>(shellInsertingHistory.size())) shellInserting = (shellInsertingHistory[value] != 0);
-    // Restore tim per-frame state
-    if (value < static_cast<int>(timIHistory.size())) timI = timIHistory[value];
-    if (value < static_cast<int>(timJHistory.size())) timJ = timJHistory[value];
-    if (value < static_cast<int>(timInsertingHistory.size())) timInserting = (timInsertingHistory[value] != 0);
-    if (value < static_cast<int>(timMergingHistory.size())) timMerging = (timMergingHistory[value] != 0);
-    if (value < static_cast<int>(timLeftHistory.size())) timLeft = timLeftHistory[value];
-    if (value < static_cast<int>(timMidHistory.size())) timMid = timMidHistory[value];
-    if (value < static_cast<int>(timRightHistory.size())) timRight = timRightHistory[value];
-
-    if (currentAlgorithm == SortAlgorithm::Quick) {
-        if (value < pivotHistory.size() &&
-            value < iHistory.size() &&
-            value < jHistory.size()) {
-
-            quickPivot = pivotHistory[value];
-            quickI = iHistory[value];
-            quickJ = jHistory[value];
-
-            highlightComparison(jHistory[value], quickPivot, quickPivot);
+    int frames = loadedTrace.isOpen() ? loadedTrace.frameCount() : static_cast<int>(history.size());
+    if (value < 0 || value >= frames) return;
+
+    int ii = -1, jj = -1, pv = -1;
+    if (loadedTrace.isOpen()) {
+        // decoded lazily from the mapped file; moving forward only applies the new frames
+        if (!loadedTrace.seek(value)) {
+            appendLog("Trace error: " + loadedTrace.errorString());
+            return;
         }
+        const TraceFrame& frame = loadedTrace.frame();
+        array = frame.array;
+        displayedSortedIndices = frame.sorted;
+        ii = frame.i;
+        jj = frame.j;
+        pv = frame.pivot;
+        applyFrameExtras(frame.extras);
     }
+    else {
+        array = history[value];
 
-    if (currentAlgorithm == SortAlgorithm::Merge) {
-        if (value >= 0 && value < history.size()) {
-            array = history[value];
-
-            if (currentAlgorithm == SortAlgorithm::Merge && value < mergeLeftStartHistory.size()) {
-                mergeLeftStart = mergeLeftStartHistory[value];
-                mergeLeftEnd = mergeLeftEndHistory[value];
-                mergeRightStart = mergeRightStartHistory[value];
-                mergeRightEnd = mergeRightEndHistory[value];
-                mergeMergedStart = mergeMergedStartHistory[value];
-                mergeMergedEnd = mergeMergedEndHistory[value];
-            }
-            int i = iHistory[value];
-            int j = jHistory[value];
-            int pivot = pivotHistory[value];
-
-            highlightComparison(i, j, pivot);
-        }
-    }
-    if (currentAlgorithm == SortAlgorithm::Heap) {
-        if (value < static_cast<int>(iHistory.size()) &&
-            value < static_cast<int>(jHistory.size()) &&
-            value < static_cast<int>(pivotHistory.size())) {
-            highlightComparison(iHistory[value], jHistory[value], pivotHistory[value]);
-        }
-    }
+        // pushFrame keeps sortedIndicesHistory aligned with history, so this only walks the
+        // indices that changed between the previously displayed frame and this one
+        sortedIndicesHistory.seek(value, displayedSortedIndices);
 
-    // General fallback: if specific algorithm handlers didn't highlight, use stored histories
-    if (!(currentAlgorithm == SortAlgorithm::Quick) && !(currentAlgorithm == SortAlgorithm::Merge) && !(currentAlgorithm == SortAlgorithm::Heap)) {
-        int ii = -1, jj = -1, pv = -1;
         if (value < static_cast<int>(iHistory.size())) ii = iHistory[value];
         if (value < static_cast<int>(jHistory.size())) jj = jHistory[value];
         if (value < static_cast<int>(pivotHistory.size())) pv = pivotHistory[value];
-        if (ii != -1 || jj != -1 || pv != -1) {
-            highlightComparison(ii, jj, pv);
-        }
+        applyFrameExtras(frameExtras(value));
     }
 
-    stepLabel->setText(QString("Step %1 / %2").arg(value).arg(history.size() - 1));
-}
+    drawArray(array);
+    currentStep = value;
+    highlightFrame(ii, jj, pv);
 
-void MainWindow::onStepModeToggled(bool checked) {
-    stepMode = checked;
-    nextStepButton->setEnabled(checked);
+    stepLabel->setText(QString("Step %1 / %2").arg(value).arg(frames - 1));
+}
 
-    if (checked) {
-        timer->stop();
-        descriptionLabel->setText("Step-by-step mode enabled. Click Next step to proceed.");
-    }
-    else {
-        timer->start(delayBox->value());
-        descriptionLabel->setText("Step-by-step mode disabled. Sorting will proceed automatically.");
-    }
+// Algorithm-specific state recorded per frame, in the order of traceExtraNames().
+static QStringList traceExtraNames() {
+    return { "radixPhase", "radixIndex", "shellI", "shellJ", "shellInserting",
+             "timI", "timJ", "timInserting", "timMerging", "timLeft", "timMid", "timRight",
+             "mergeLeftStart", "mergeLeftEnd", "mergeRightStart", "mergeRightEnd", "mergeMergedStart", "mergeMergedEnd",
+             "dualLeft", "dualRight", "timRunWidth", "rotateFirst", "rotateMiddle", "rotateLast",
+             "naturalRunStart", "naturalRunEnd", "naturalRunsLeft" };
 }
 
-void MainWindow::onResetClicked() {
+std::vector<int> MainWindow::frameExtras(int f) const {
+    // a history that was not recorded for this run keeps the live value, as scrubbing always did
+    auto at = [f](const auto& hist, int live) {
+        return f < static_cast<int>(hist.size()) ? static_cast<int>(hist[f]) : live;
+    };
+    return { at(radixPhaseHistory, static_cast<int>(radixPhase)), at(radixIndexHistory, radixIndex),
+             at(shellIHistory, shellI), at(shellJHistory, shellJ), at(shellInsertingHistory, shellInserting ? 1 : 0),
+             at(timIHistory, timI), at(timJHistory, timJ), at(timInsertingHistory, timInserting ? 1 : 0),
+             at(timMergingHistory, timMerging ? 1 : 0), at(timLeftHistory, timLeft), at(timMidHistory, timMid),
+             at(timRightHistory, timRight),
+             at(mergeLeftStartHistory, mergeLeftStart), at(mergeLeftEndHistory, mergeLeftEnd),
+             at(mergeRightStartHistory, mergeRightStart), at(mergeRightEndHistory, mergeRightEnd),
+             at(mergeMergedStartHistory, mergeMergedStart), at(mergeMergedEndHistory, mergeMergedEnd),
+             at(dualLeftHistory, dualLeft), at(dualRightHistory, dualRight), at(timRunWidthHistory, timRunWidth),
+             at(rotateFirstHistory, rotateFirst), at(rotateMiddleHistory, rotateMiddle), at(rotateLastHistory, rotateLast),
+             at(naturalRunStartHistory, naturalRunStart), at(naturalRunEndHistory, naturalRunEnd),
+             at(naturalRunsLeftHistory, naturalRunsLeft) };
+}
 
-    timer->stop();
+void MainWindow::applyFrameExtras(const std::vector<int>& e) {
+    if (e.size() < 18) return;
+    radixPhase = static_cast<RadixPhase>(e[0]);
+    radixIndex = e[1];
+    shellI = e[2];
+    shellJ = e[3];
+    shellInserting = e[4] != 0;
+    timI = e[5];
+    timJ = e[6];
+    timInserting = e[7] != 0;
+    timMerging = e[8] != 0;
+    timLeft = e[9];
+    timMid = e[10];
+    timRight = e[11];
+    mergeLeftStart = e[12];
+    mergeLeftEnd = e[13];
+    mergeRightStart = e[14];
+    mergeRightEnd = e[15];
+    mergeMergedStart = e[16];
+    mergeMergedEnd = e[17];
+    // traces saved before dual-pivot quick sort stop here
+    dualLeft = e.size() > 19 ? e[18] : -1;
+    dualRight = e.size() > 19 ? e[19] : -1;
+    timRunWidth = e.size() > 20 ? e[20] : 0;
+    rotateFirst = e.size() > 23 ? e[21] : -1;
+    rotateMiddle = e.size() > 23 ? e[22] : -1;
+    rotateLast = e.size() > 23 ? e[23] : -1;
+    naturalRunStart = e.size() > 26 ? e[24] : -1;
+    naturalRunEnd = e.size() > 26 ? e[25] : -1;
+    naturalRunsLeft = e.size() > 26 ? e[26] : 0;
+}
 
-    scene->clear();
-    stepLabel->clear();
-    logView->clear();
+void MainWindow::clearHistory() {
+    loadedTrace.close();
 
     history.clear();
+    frameChangeHistory.clear();
     pivotHistory.clear();
     iHistory.clear();
     jHistory.clear();
@@ -790,33 +1130,205 @@ void MainWindow::onResetClicked() {
     mergeRightEndHistory.clear();
     mergeMergedStartHistory.clear();
     mergeMergedEndHistory.clear();
+    dualLeftHistory.clear();
+    dualRightHistory.clear();
+    timRunWidthHistory.clear();
+    rotateFirstHistory.clear();
+    rotateMiddleHistory.clear();
+    rotateLastHistory.clear();
+    naturalRunStartHistory.clear();
+    naturalRunEndHistory.clear();
+    naturalRunsLeftHistory.clear();
+}
 
-    displayedSortedIndices.clear();
+bool MainWindow::writeTrace(const QString& path, QString& error) {
+    TraceHeader header;
+    header.algorithm = algorithmName(currentAlgorithm);
+    header.input = runInput;
+    header.extraNames = traceExtraNames();
+    header.metadata.append({ "created", QDateTime::currentDateTime().toString(Qt::ISODate) });
+    header.metadata.append({ "source", "SortingAlgorithms GUI" });
+
+    TraceWriter writer;
+    if (!writer.open(path, header)) {
+        error = writer.errorString();
+        return false;
+    }
+    for (int f = 0; f < static_cast<int>(history.size()); ++f) {
+        writer.addFrame(history[f], iHistory[f], jHistory[f], pivotHistory[f],
+                        sortedIndicesHistory.frameEntries(f), frameExtras(f));
+    }
+    if (!writer.finish()) {
+        error = writer.errorString();
+        return false;
+    }
+    return true;
+}
+
+void MainWindow::onSaveTraceClicked() {
+    if (history.empty()) {
+        QMessageBox::information(this, "Save Trace", "Run an algorithm first; there is no recorded run to save.");
+        return;
+    }
+
+    QString path = QFileDialog::getSaveFileName(this, "Save Trace", QString(), "Sort traces (*.strace);;All files (*)");
+    if (path.isEmpty()) return;
+
+    QString error;
+    if (!writeTrace(path, error)) {
+        QMessageBox::warning(this, "Save Trace", error);
+        return;
+    }
+
+    appendLog(QString("Saved %1 frames to %2").arg(history.size()).arg(path));
+}
+
+void MainWindow::onExportFramesClicked() {
+    if (!loadedTrace.isOpen() && history.empty()) {
+        QMessageBox::information(this, "Export Frames", "Run an algorithm or load a trace first.");
+        return;
+    }
+    int frames = loadedTrace.isOpen() ? loadedTrace.frameCount() : static_cast<int>(history.size());
+
+    QString filter;
+    QString path = QFileDialog::getSaveFileName(this, "Export Frames", QString(),
+                                                "PNG sequence (*.png);;Y4M video (*.y4m)", &filter);
+    if (path.isEmpty()) return;
+
+    bool ok = false;
+    int every = QInputDialog::getInt(this, "Export Frames", QString("Export every Nth frame (%1 frames):").arg(frames),
+                                     std::max(1, frames / 3600), 1, std::max(1, frames), 1, &ok);
+    if (!ok) return;
+
+    FrameExportOptions options;
+    options.every = every;
+    if (path.endsWith(".y4m", Qt::CaseInsensitive) || (filter.contains("y4m") && !path.endsWith(".png", Qt::CaseInsensitive))) {
+        options.format = FrameExportOptions::Format::Y4m;
+        options.outputPath = path.endsWith(".y4m", Qt::CaseInsensitive) ? path : path + ".y4m";
+    }
+    else {
+        QFileInfo info(path);
+        options.outputPath = info.dir().filePath(info.completeBaseName());
+    }
+
+    // the exporter reads from a trace file; a live run is saved to a temporary one first
+    QTemporaryDir tempDir;
+    QString tracePath = loadedTracePath;
+    if (!loadedTrace.isOpen()) {
+        QString error;
+        tracePath = tempDir.filePath("run.strace");
+        if (!tempDir.isValid() || !writeTrace(tracePath, error)) {
+            QMessageBox::warning(this, "Export Frames", error.isEmpty() ? "Could not create a temporary file." : error);
+            return;
+        }
+    }
+
+    timer->stop();
+    stopPlayback();
+
+    QProgressDialog progressDialog("Rendering frames...", "Cancel", 0, 100, this);
+    progressDialog.setWindowModality(Qt::WindowModal);
+    progressDialog.setMinimumDuration(300);
+
+    QElapsedTimer clock;
+    clock.start();
+    QString error;
+    bool exported = exportTraceFrames(tracePath, options, error, [&](int done, int total) {
+        progressDialog.setMaximum(total);
+        progressDialog.setValue(done);
+        return !progressDialog.wasCanceled();
+    });
+    progressDialog.reset();
+
+    if (!exported) {
+        QMessageBox::warning(this, "Export Frames", error);
+        return;
+    }
+    appendLog(QString("Exported %1 frames (every %2 steps) to %3 in %4 ms").arg((frames + every - 1) / every).arg(every).arg(options.outputPath).arg(clock.elapsed()));
+}
+
+void MainWindow::onLoadTraceClicked() {
+    QString path = QFileDialog::getOpenFileName(this, "Load Trace", QString(), "Sort traces (*.strace);;All files (*)");
+    if (path.isEmpty()) return;
+
+    timer->stop();
+    stopPlayback();
+    clearHistory();
+    resetDisplayState();
     sortedIndices.clear();
+    displayedSortedIndices.clear();
 
-    slider->setValue(0);
-    slider->setMaximum(0);
-    currentStep = 0;
+    if (!loadedTrace.open(path)) {
+        QMessageBox::warning(this, "Load Trace", loadedTrace.errorString());
+        return;
+    }
+    loadedTracePath = path;
 
-    i = j = -1;
-    quickStack.clear(); quickI = quickJ = quickPivot = -1; pivotValue = -1;
-    mergeStack = {};
-    mergeBuffer.clear(); merging = false;
-    mergeLeft = mergeMid = mergeRight = -1;
-    mergeI = mergeJ = mergeK = -1;
-    mergeLeftStart = mergeLeftEnd = mergeRightStart = mergeRightEnd = mergeMergedStart = mergeMergedEnd = -1;
+    const TraceHeader& header = loadedTrace.header();
+    SortAlgorithm alg;
+    if (algorithmFromName(header.algorithm.toStdString(), alg)) {
+        currentAlgorithm = alg;
+        algorithmBox->setCurrentText(header.algorithm);
+    }
+
+    runInput = header.input;
+    QStringList numbers;
+    for (int v : runInput) numbers << QString::number(v);
+    inputField->setText(numbers.join(" "));
+    updateMetrics(runInput);
+
+    logView->clear();
+    appendLog(QString("Loaded trace %1: %2, %3 elements, %4 frames.")
+                  .arg(path).arg(header.algorithm).arg(runInput.size()).arg(loadedTrace.frameCount()));
+    for (const auto& kv : header.metadata) appendLog(QString("  %1: %2").arg(kv.first, kv.second));
+
+    {
+        QSignalBlocker block(slider);
+        slider->setMaximum(std::max(0, loadedTrace.frameCount() - 1));
+        slider->setValue(0);
+    }
+    onSliderMoved(0);
+}
+
+void MainWindow::onStepModeToggled(bool checked) {
+    stepMode = checked;
+    nextStepButton->setEnabled(checked);
+
+    if (playbackActive()) {
+        if (checked) playbackTimer->stop();
+        else playbackTimer->start(playbackPlan.intervalMs);
+        return;
+    }
+
+    if (checked) {
+        timer->stop();
+        descriptionLabel->setText("Step-by-step mode enabled. Click Next step to proceed.");
+    }
+    else {
+        timer->start(delayBox->value());
+        descriptionLabel->setText("Step-by-step mode disabled. Sorting will proceed automatically.");
+    }
+}
+
+void MainWindow::onResetClicked() {
+
+    timer->stop();
+    stopPlayback();
 
-    heapStack = std::stack<int>(); heapBuilding = false; heapSwapping = false; heapI = heapJ = -1; heapSize = 0;
+    view->setHeader(QString());
+    stepLabel->clear();
+    logView->clear();
 
-    gap = (sizeSpinBox) ? (sizeSpinBox->value() / 2) : 0;
-    shellI = shellJ = -1; shellInserting = false;
+    clearHistory();
 
-    timRuns.clear(); timInserting = false; timMerging = false; timStart = timEnd = timI = timJ = -1;
-    timLeft = timMid = timRight = -1; timMergeBuffer.clear();
+    displayedSortedIndices.clear();
+    sortedIndices.clear();
 
-    radixInitialized = false; digitPlace = 1; radixIndex = 0; radixPhase = RadixPhase::Count; std::fill(count.begin(), count.end(), 0); bucket.clear();
+    slider->setValue(0);
+    slider->setMaximum(0);
+    currentStep = 0;
 
-    gnomeIndex = 0;
+    resetDisplayState();
 
     array.clear();
     QStringList numberStrings = inputField->text().split(" ", Qt::SkipEmptyParts);
@@ -830,6 +1342,7 @@ void MainWindow::onResetClicked() {
         generateArrayFromControls(false);
     } else {
         drawArray(array);
+        updateMetrics(array);
     }
 
     appendLog("Reset state (preserved algorithm & input).");
@@ -840,21 +1353,10 @@ void MainWindow::onStartClicked() {
     QString selected = algorithmBox->currentText();
 
 
+    stopPlayback();
+
     // Reset histories
-    history.clear();
-    pivotHistory.clear();
-    iHistory.clear();
-    jHistory.clear();
-    // Clear any per-frame recorded histories
-    sortedIndicesHistory.clear();
-    radixPhaseHistory.clear();
-    radixIndexHistory.clear();
-    mergeLeftStartHistory.clear();
-    mergeLeftEndHistory.clear();
-    mergeRightStartHistory.clear();
-    mergeRightEndHistory.clear();
-    mergeMergedStartHistory.clear();
-    mergeMergedEndHistory.clear();
+    clearHistory();
     slider->setValue(0);
     slider->setMaximum(0);
     currentStep = 0;
@@ -879,1234 +1381,758 @@ void MainWindow::onStartClicked() {
         return;
     }
 
+    runInput = array;
+    updateMetrics(runInput);
+
     logView->clear();
     appendLog("Input: " + inputField->text());
 
-    if (selected == "Bubble Sort") {
-        currentAlgorithm = SortAlgorithm::Bubble;
-
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
-
-        i = 0; j = 0;
+    if (selected == "Auto") {
+        std::string why;
+        Presortedness shape = measurePresortedness(array);
+        SortAlgorithm chosen = chooseAlgorithm(shape, &why);
+        appendLog(QString("Input shape: %1 runs, ~%2% inversions, ~%3% duplicates, key range %4.")
+                      .arg(shape.runs).arg(100 * shape.inversionRatio, 0, 'f', 1)
+                      .arg(100 * shape.duplicateRatio, 0, 'f', 1).arg(shape.range));
+        appendLog(QString("Auto chose %1: %2.").arg(algorithmName(chosen), QString::fromStdString(why)));
+        selected = algorithmName(chosen);
+        onAlgorithmSelected(selected); // legend and pseudocode of the algorithm that actually runs
+    }
+
+    if (!algorithmFromName(selected.toStdString(), currentAlgorithm)) return;
+    resetDisplayState();
+    heapBuilding = (currentAlgorithm == SortAlgorithm::Heap);
+    sortedIndices.clear();
 
-        appendLog("Starting Bubble Sort.");
-        // show pseudocode (already set in onAlgorithmSelected) and highlight first line
-        highlightPseudocodeLine(0);
+    // The engine sorts a copy right away; the ticks then replay its recorded steps, so what is
+    // animated is exactly the code the race and the command line run.
+    const SortOptions options = currentSortOptions();
+    const bool quick = (currentAlgorithm == SortAlgorithm::Quick || currentAlgorithm == SortAlgorithm::Quick3 ||
+                        currentAlgorithm == SortAlgorithm::DualPivot);
+
+    SortEngine::RecordingTracer recorder;
+    std::vector<int> work = array;
+    SortEngine::run(currentAlgorithm, work, recorder, options);
+    runSteps = std::move(recorder.steps);
+    runPos = 0;
+
+    // Time the untraced instantiation of the same template: no recording, formatting or drawing.
+    std::vector<int> timed = array;
+    SortEngine::NullTracer untraced;
+    QElapsedTimer clock;
+    clock.start();
+    SortEngine::run(currentAlgorithm, timed, untraced, options);
+    double engineMs = clock.nsecsElapsed() / 1e6;
+
+    pushFrame(array, -1, -1, -1);
+    appendLog(QString("Starting %1 (%2 recorded steps; the sort itself takes %3 ms).")
+                  .arg(selected).arg(runSteps.size()).arg(engineMs, 0, 'f', 3));
+    if (quick) {
+        long long comparisons = std::count_if(runSteps.begin(), runSteps.end(), [](const SortEngine::SortStep& s) {
+            return s.kind == SortEngine::SortStep::Kind::Compare;
+        });
+        appendLog(QString("Pivot: %1; %2 comparisons, peak stack depth %3.")
+                      .arg(pivotStrategyName(options.pivot)).arg(comparisons).arg(recorder.peakDepth));
     }
-    else if (selected == "Insertion Sort") {
-        currentAlgorithm = SortAlgorithm::Insertion;
-        i = 1; j = 0; key = 0; inserting = false;
+    if (currentAlgorithm == SortAlgorithm::Heap) {
+        long long comparisons = std::count_if(runSteps.begin(), runSteps.end(), [](const SortEngine::SortStep& s) {
+            return s.kind == SortEngine::SortStep::Kind::Compare;
+        });
+        appendLog(QString("Heap: %1; %2 comparisons.").arg(heapVariantName(options.heap)).arg(comparisons));
+    }
+    if (currentAlgorithm == SortAlgorithm::Bitonic) {
+        appendLog(QString("The timed run is the parallel version: stages split over %1 threads, %2 compare-exchanges inside.")
+                      .arg(SortEngine::bitonicThreads(static_cast<long long>(array.size())))
+                      .arg(SortEngine::simdSortIsa()));
+    }
+    if (currentAlgorithm == SortAlgorithm::Counting && !array.empty()) {
+        auto [lo, hi] = std::minmax_element(array.begin(), array.end());
+        const long long range = static_cast<long long>(*hi) - *lo;
+        appendLog(SortEngine::countingSortApplies(static_cast<long long>(array.size()), range)
+                      ? QString("%1 keys from %2 to %3: counting them.").arg(range + 1).arg(*lo).arg(*hi)
+                      : QString("%1 keys from %2 to %3 is too wide to count; running Radix Sort instead.").arg(range + 1).arg(*lo).arg(*hi));
+    }
+    if (currentAlgorithm == SortAlgorithm::Bucket) {
+        appendLog(QString("%1 buckets; the timed run is the parallel version with per-thread histograms, over %2 threads.")
+                      .arg(SortEngine::bucketCount(static_cast<long long>(array.size())))
+                      .arg(SortEngine::bucketThreads(static_cast<long long>(array.size()))));
+    }
+    if (currentAlgorithm == SortAlgorithm::Network) {
+        int depth = 0;
+        networkComparators = SortEngine::sortingNetwork(static_cast<int>(array.size()), &depth);
+        networkLayerWires.assign(array.size(), 0);
+        appendLog(QString("The network for %1 elements has %2 comparators in %3 layers%4.")
+                      .arg(array.size()).arg(networkComparators.size()).arg(depth)
+                      .arg(array.size() <= 8 ? " (size-optimal)" : ""));
+    }
+    highlightPseudocodeLine(0);
 
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
+    drawArray(array);
 
-        appendLog("Starting Insertion Sort.");
-        highlightPseudocodeLine(0);
+    if (durationSpinBox->value() > 0) {
+        recordAndPlay(durationSpinBox->value() * 1000);
+        return;
     }
-    else if (selected == "Selection Sort") {
-        currentAlgorithm = SortAlgorithm::Selection;
-        i = 0; j = 0; minIndex = 0;
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
 
-        pushFrame(array, -1, -1, -1);
-        appendLog("Selection Sort starting.");
+    // Timer logic
+    stepMode = stepByStepCheck->isChecked();
+    if (stepMode) {
+        timer->stop();
+        nextStepButton->setEnabled(true);
+        descriptionLabel->setText("Step-by-step mode: click 'Next Step' to begin.");
+    }
+    else {
+        timer->start(delayBox->value());
+    }
+}
 
-        if (timer && !timer->isActive())
-            timer->start(delayBox->value());
+void MainWindow::recordAndPlay(int durationMs) {
+    // Run the algorithm to completion without drawing or logging. Every algorithm stops
+    // the timer when it finishes, so the timer doubles as the "still running" flag here.
+    recordingOnly = true;
+    stepMode = false;
+    timer->start(delayBox->value());
+    while (timer->isActive()) onTimerTick();
+    pushFrame(array, -1, -1, -1); // final state
+    recordingOnly = false;
 
-        appendLog("Starting Selection Sort.");
-        highlightPseudocodeLine(0);
+    {
+        QSignalBlocker block(slider);
+        slider->setMaximum(static_cast<int>(history.size()) - 1);
     }
-    else if (selected == "Quick Sort") {
-        currentAlgorithm = SortAlgorithm::Quick;
 
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
+    playbackPlan = planPlayback(frameChangeHistory, durationMs);
+    playbackPos = 0;
 
-        quickStack.clear();
-        if (!array.empty()) {
-            quickStack.push({ 0, static_cast<int>(array.size() - 1) });
-        }
+    int shown = static_cast<int>(playbackPlan.frames.size());
+    appendLog(QString("Recorded %1 steps; showing %2 of them over %3 s (%4 ms per frame, ~%5 steps per frame).")
+                  .arg(history.size()).arg(shown).arg(durationMs / 1000.0)
+                  .arg(playbackPlan.intervalMs).arg(static_cast<double>(history.size()) / std::max(1, shown), 0, 'f', 1));
 
-        quickI = quickJ = quickPivot = -1;
-        appendLog("Starting Quick Sort.");
-        highlightPseudocodeLine(0);
+    stepMode = stepByStepCheck->isChecked();
+    nextStepButton->setEnabled(stepMode);
+    if (stepMode)
+        descriptionLabel->setText("Step-by-step mode: click 'Next Step' to advance the playback.");
+    else
+        playbackTimer->start(playbackPlan.intervalMs);
+}
+
+void MainWindow::onPlaybackTick() {
+    if (!playbackActive()) {
+        playbackTimer->stop();
+        return;
     }
-    else if (selected == "Merge Sort") {
-        currentAlgorithm = SortAlgorithm::Merge;
-        mergeStack = {};
-        mergeBuffer = array;
-        mergeStack.push({ 0, static_cast<int>(array.size() - 1), false }); // false = split phase
-        merging = false;
-
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
-
-        mergeLeft = mergeMid = mergeRight = -1;
-        mergeI = mergeJ = mergeK = -1;
-
-        mergeLeftStart = mergeLeftEnd = -1;
-        mergeRightStart = mergeRightEnd = -1;
-        mergeMergedStart = mergeMergedEnd = -1;
 
-        appendLog("Starting Merge Sort...");
-        highlightPseudocodeLine(0);
+    int frame = playbackPlan.frames[playbackPos++];
+    {
+        QSignalBlocker block(slider);
+        slider->setValue(frame);
     }
-    else if (selected == "Heap Sort") {
-        currentAlgorithm = SortAlgorithm::Heap;
-
-        // Reset heap state
-        heapStack = std::stack<int>();
-        heapBuilding = true;
-        heapSwapping = false;
-        heapI = heapJ = -1;
-        heapSize = static_cast<int>(array.size());
-
-        // Clear visualization state
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
-
-        int lastNonLeaf = heapSize / 2 - 1;
-        for (int k = 0; k <= lastNonLeaf; ++k) {
-            heapStack.push(k);
-        }
+    onSliderMoved(frame);
 
-        pushFrame(array, -1, -1, -1);
+    if (!playbackActive()) {
+        playbackTimer->stop();
+        drawArrayFinished(array);
+        appendLog("Playback complete.");
+    }
+}
 
-        appendLog(QString("Heap Sort starting. heapSize=%1").arg(heapSize));
+void MainWindow::stopPlayback() {
+    playbackTimer->stop();
+    playbackPlan = PlaybackPlan();
+    playbackPos = 0;
+}
 
-        if (timer && !timer->isActive()) timer->start(delayBox->value());
-        highlightPseudocodeLine(0);
+void MainWindow::onTimerTick() {
+    // "Next Step" drives the planned playback when one is running
+    if (playbackActive()) {
+        onPlaybackTick();
+        return;
     }
-    else if (selected == "Shell Sort") {
-        currentAlgorithm = SortAlgorithm::Shell;
 
-        gap = array.size() / 2;
-        shellI = gap;
-        shellInserting = false;
-
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
-
-        pushFrame(array, -1, -1, -1);
-
-        appendLog(QString("Shell Sort starting. gap=%1").arg(gap));
-
-        if (timer && !timer->isActive()) timer->start(delayBox->value());
-        highlightPseudocodeLine(0);
-    }
-    else if (selected == "Tim Sort") {
-        currentAlgorithm = SortAlgorithm::Tim;
-
-        timRunSize = 32;
-
-        timRuns.clear();
-        timInserting = true;
-        timMerging = false;
-
-        timStart = 0;
-        timEnd = std::min(timStart + timRunSize, (int)array.size());
-
-        timI = timStart + 1;
-        timJ = timI;
-        timKey = (timI < timEnd) ? array[timI] : 0;
-
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
-
-        pushFrame(array, -1, -1, -1);
-
-        appendLog(QString("TimSort starting. runSize=%1").arg(timRunSize));
-
-        if (timer && !timer->isActive())
-            timer->start(delayBox->value());
-        highlightPseudocodeLine(0);
-    }
-    else if (selected == "Radix Sort") {
-        currentAlgorithm = SortAlgorithm::Radix;
-
-        radixInitialized = false;
-        digitPlace = 1;
-        radixIndex = 0;
-        radixPhase = RadixPhase::Count;
-        maxValue = *std::max_element(array.begin(), array.end());
-        std::fill(count.begin(), count.end(), 0);
-        bucket.resize(array.size());
-
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
-
-        pushFrame(array, -1, -1, -1);
-
-        appendLog(QString("Radix Sort starting. maxValue=%1").arg(maxValue));
+    // Clear any scrubbing overlay so live state controls highlighting
+    displayedSortedIndices.clear();
 
-        if (timer && !timer->isActive())
-            timer->start(delayBox->value());
-        highlightPseudocodeLine(0);
+    if (runPos >= runSteps.size()) {
+        finishRun();
+        return;
     }
-    else if (selected == "Gnome Sort") {
-        currentAlgorithm = SortAlgorithm::Gnome;
 
-        sortedIndices.clear();
-        history.clear();
-        iHistory.clear();
-        jHistory.clear();
-        pivotHistory.clear();
-
-        gnomeIndex = 0;
-        pushFrame(array, -1, -1, -1);
-
-        appendLog("Starting Gnome Sort.");
-
-        if (timer && !timer->isActive())
-            timer->start(delayBox->value());
-        highlightPseudocodeLine(0);
-    }
-
-    drawArray(array);
-
-    // Timer logic
-    stepMode = stepByStepCheck->isChecked();
-    if (stepMode) {
-        timer->stop();
-        nextStepButton->setEnabled(true);
-        descriptionLabel->setText("Step-by-step mode: click 'Next Step' to begin.");
-    }
-    else {
-        timer->start(delayBox->value());
+    // marks only update the display state; keep going until an event that gets a tick of its own
+    while (runPos < runSteps.size() && !presentStep(runSteps[runPos++])) {
     }
 }
 
-void MainWindow::onTimerTick() {
-    // Clear any scrubbing overlay so live state controls highlighting
-    displayedSortedIndices.clear();
-
-    // Bubble sort step
-    if (currentAlgorithm == SortAlgorithm::Bubble) {
-        if (i < static_cast<int>(array.size())) {
-            if (j < static_cast<int>(array.size()) - i - 1) {
-
-
-
-                appendLog(QString("Comparing positions %1 and %2 (%3 vs %4).").arg(j).arg(j + 1).arg(array[j]).arg(array[j + 1]));
-
-                // Record this comparison frame with indices so scrubbing can show highlights
-                pushFrame(array, j, j + 1, -1);
-
-                appendLog(stepLabel->text());
+// Applies one recorded event. Returns true for comparisons, writes and the other events that are
+// shown as a step of their own (and recorded as a frame); the rest only change what the next
+// step is drawn with.
+bool MainWindow::presentStep(const SortEngine::SortStep& s) {
+    using Kind = SortEngine::SortStep::Kind;
 
-                // pseudocode line: compare (0-based index 2 => step 3 in displayed list)
-                highlightPseudocodeLine(2);
-                highlightComparison(j, j + 1, -1);
-                if (array[j] > array[j + 1]) {
-                    appendLog(QString("Swap: %1 > %2 -> swapping.").arg(array[j]).arg(array[j + 1]));
+    int line = pseudocodeLine(s);
+    if (line >= 0) highlightPseudocodeLine(line);
 
-                    std::swap(array[j], array[j + 1]);
-                    // drawArray(array);
+    if (s.kind == Kind::Compare) {
+        if (s.y >= 0)
+            appendLog(QString("Comparing index %1 (%2) with index %3 (%4).").arg(s.x).arg(array[s.x]).arg(s.y).arg(array[s.y]));
+        else
+            appendLog(QString("Comparing index %1 (%2) with the key.").arg(s.x).arg(array[s.x]));
 
-                    // show the swap pseudocode line
-                    highlightPseudocodeLine(3);
-                }
-                else {
-                    appendLog(QString("No swap: %1 <= %2.").arg(array[j]).arg(array[j + 1]));
-                }
-                j++;
-                if (stepMode) {
-                    timer->stop();
-                    return;
-                }
+        switch (currentAlgorithm) {
+        case SortAlgorithm::Insertion:
+            showStep(s.x + 1, s.x, -1); // hole left by the key, element compared with it
+            break;
+        case SortAlgorithm::Selection:
+            showStep(s.y, s.x, -1);     // current minimum, candidate
+            break;
+        case SortAlgorithm::Quick:
+            if (quickPartitioning) showStep(-1, s.x, quickPivot);
+            else showStep(-1, s.x, s.y); // pivot candidates
+            break;
+        case SortAlgorithm::Quick3:
+            if (quickPartitioning) {
+                quickI = s.x;
+                showStep(quickI, quickJ, quickPivot); // i, gt, lt
             }
             else {
-
-                int settledIndex = array.size() - i - 1;
-                sortedIndices.insert(settledIndex);
-
-                appendLog(QString("Pass %1 complete. Largest element settled at position %2.").arg(i + 1).arg(array.size() - i - 1));
-
-                // mark settled pseudocode line
-                highlightPseudocodeLine(4);
-                highlightComparison(settledIndex, -1, -1);
-
-                j = 0;
-                i++;
+                showStep(s.x, s.y, -1);
             }
-        }
-        else {
-            timer->stop();
-            appendLog("Sorting complete.");
-            appendLog("Array is sorted.");
-            highlightPseudocodeLine(5);
-
-            for (int k = 0; k < array.size(); ++k) {
-                sortedIndices.insert(k);
+            break;
+        case SortAlgorithm::DualPivot:
+            if (!quickPartitioning) {
+                showStep(s.x, s.y, -1); // pivot samples, or the two pivots
+                break;
             }
-            highlightComparison(-1, -1, -1);
-
-            drawArrayFinished(array);
-        }
-
-    }
-    // End bubble sort
-
-    // Insertion sort step
-    else if (currentAlgorithm == SortAlgorithm::Insertion) {
-        if (i < static_cast<int>(array.size())) {
-            if (!inserting) {
-                key = array[i];
-                j = i - 1;
-                inserting = true;
-
-                pushFrame(array, i, -1, -1);
-
-                appendLog(QString("Taking key = %1 at index %2").arg(key).arg(i));
-                appendLog(stepLabel->text());
-
-                // pseudocode: taking key (line 1)
-                highlightPseudocodeLine(1);
-                highlightComparison(i, -1, -1);
-                return;
+            // the scan for gt compares A[gt] with the right pivot while k waits
+            if (s.y == dualRight && s.x != quickI) quickJ = s.x;
+            showStep(quickI, quickJ, quickPivot); // k, gt, lt
+            break;
+        case SortAlgorithm::Shell:
+            shellJ = s.x;
+            showStep(shellI, s.x, -1);
+            break;
+        case SortAlgorithm::Tim:
+        case SortAlgorithm::BlockMerge:
+        case SortAlgorithm::NaturalMerge:
+            rotateFirst = rotateMiddle = rotateLast = -1;
+            if (timInserting) {
+                timJ = s.x;
+                showStep(timI, s.x, -1);
             }
             else {
-                if (j >= 0 && array[j] > key) {
-                    appendLog(QString("Shifting %1 right (index %2)").arg(array[j]).arg(j));
-
-                    pushFrame(array, j, j + 1, -1);
-
-                    appendLog(stepLabel->text());
-                    array[j + 1] = array[j];
-
-                    // pseudocode: shifting (line 2)
-                    highlightPseudocodeLine(2);
-                    highlightComparison(j, j + 1, -1);
-
-                    j--;
-                    return;
-                }
-                else {
-                    pushFrame(array, j + 1, -1, -1);
-
-                    array[j + 1] = key;
-                    appendLog(QString("Inserting key %1 at index %2").arg(key).arg(j + 1));
-                    appendLog(stepLabel->text());
-
-                    // pseudocode: insert (line 3)
-                    highlightPseudocodeLine(3);
-                    highlightComparison(j + 1, -1, -1);
-
-                    i++;
-                    inserting = false;
-                    return;
-                }
-                if (stepMode) {
-                    timer->stop();
-                    return;
-                }
+                showStep(s.x, s.y, -1);
             }
+            break;
+        default:
+            showStep(s.x, s.y, -1);
+            break;
         }
-        else {
-            timer->stop();
-            appendLog("Insertion Sort complete.");
-            appendLog("Array is sorted.");
-            highlightPseudocodeLine(4);
-
-            for (int k = 0; k < array.size(); ++k) {
-                sortedIndices.insert(k);
-            }
-            highlightComparison(-1, -1, -1);
-
-            drawArrayFinished(array);
-        }// End insertion sort
-
+        return true;
     }
 
-
-    // Selection sort step
-    else if (currentAlgorithm == SortAlgorithm::Selection) {
-        if (i < static_cast<int>(array.size()) - 1) {
-            if (j < static_cast<int>(array.size())) {
-
-                pushFrame(array, j, minIndex, -1);
-
-
-                appendLog(QString("Comparing index %1 (%2) with current min index %3 (%4)")
-                    .arg(j).arg(array[j]).arg(minIndex).arg(array[minIndex]));
-                appendLog(stepLabel->text());
-
-                // show "for j" comparison line (line 2)
-                highlightPseudocodeLine(2);
-                highlightComparison(j, minIndex, -1);
-
-                if (array[j] < array[minIndex]) {
-                    minIndex = j;
-                    appendLog(QString("New minimum found at index %1 (%2)").arg(minIndex).arg(array[minIndex]));
-                }
-                j++;
-                return;
-            }
-            else {
-                if (minIndex != i) {
-                    std::swap(array[i], array[minIndex]);
-                    appendLog(QString("Swapping index %1 (%2) with min index %3 (%4)")
-                        .arg(i).arg(array[minIndex]).arg(minIndex).arg(array[i]));
-
-                    highlightPseudocodeLine(3);
-                }
-                else {
-                    appendLog(QString("No swap needed for index %1").arg(i));
-                }
-                i++;
-                if (stepMode) {
-                    timer->stop();
-                    return;
-                }
-                j = i;
-                minIndex = i;
-                return;
-            }
+    if (s.kind == Kind::Write) {
+        array[s.x] = s.vx;
+        if (s.y >= 0) {
+            array[s.y] = s.vy;
+            appendLog(QString("Swapped index %1 and %2 (now %3 and %4).").arg(s.x).arg(s.y).arg(s.vx).arg(s.vy));
         }
         else {
-            timer->stop();
-            appendLog("Selection Sort complete.");
-            appendLog("Array is sorted.");
-            drawArrayFinished(array);
-            highlightPseudocodeLine(4);
-        }
-
-    }
-
-    // End selection sort
-
-    // Quick sort step
-
-    else if (currentAlgorithm == SortAlgorithm::Quick) {
-        while (!quickStack.isEmpty() && quickI == -1 && quickJ == -1) {
-            auto [left, right] = quickStack.top();
-            quickStack.pop();
-            if (left < right) {
-                quickLeft = left;
-                quickRight = right;
-                pivotValue = array[right];
-                quickPivot = quickRight;
-                quickI = left - 1;
-                quickJ = left;
-                appendLog(QString("Partitioning from %1 to %2 with pivot %3").arg(left).arg(right).arg(pivotValue));
-                appendLog(stepLabel->text());
-
-                // pseudocode: choose pivot / initialize partition (line 0 or 1)
-                highlightPseudocodeLine(0);
-                highlightComparison(-1, -1, quickRight);
-
-                pushFrame(array, quickI, quickJ, quickRight);
-                return;
-            }
+            appendLog(QString("Wrote %1 to index %2.").arg(s.vx).arg(s.x));
         }
 
-        if (quickJ >= 0 && quickJ < quickRight) {
-            appendLog(QString("Comparing %1 with pivot %2").arg(array[quickJ]).arg(pivotValue));
-            appendLog(stepLabel->text());
-            // pseudocode: comparing line
-            highlightPseudocodeLine(1);
-            highlightComparison(quickJ, quickRight, quickRight);
-            pushFrame(array, quickI, quickJ, quickRight);
-
-            if (array[quickJ] < pivotValue) {
-                quickI++;
-                std::swap(array[quickI], array[quickJ]);
-                drawArray(array);
-                appendLog(QString("Swapped %1 and %2").arg(array[quickI]).arg(array[quickJ]));
-
-                // pseudocode: swap occurred (line 2)
-                highlightPseudocodeLine(2);
-
-                pushFrame(array, quickI, quickJ, quickRight);
-            }
-            quickJ++;
-            if (stepMode) {
-                timer->stop();
-                return;
-            }
-            return;
-        }
-
-        if (quickJ == quickRight) {
-            std::swap(array[quickI + 1], array[quickRight]);
-            drawArray(array);
-
-
-            highlightComparison(-1, -1, quickI + 1);
-
-            int pivotIndex = quickI + 1;
-            appendLog(QString("Placed pivot %1 at index %2").arg(array[pivotIndex]).arg(pivotIndex));
-            quickStack.push({ quickLeft, pivotIndex - 1 });
-            quickStack.push({ pivotIndex + 1, quickRight });
-
-            quickI = quickJ = quickPivot = -1;
-            pivotValue = -1;
-
-            pushFrame(array, quickI, quickJ, pivotIndex);
-
-            // pseudocode: placing pivot (line 3)
-            highlightPseudocodeLine(3);
-
-            return;
-        }
-
-        if (quickStack.isEmpty() && quickI == -1 && quickJ == -1) {
-            timer->stop();
-            appendLog("Quick Sort complete.");
-            appendLog("Array is sorted.");
-            for (int k = 0; k < array.size(); ++k) sortedIndices.insert(k);
-            highlightComparison(-1, -1, -1);
-
-            drawArrayFinished(array);
-            highlightPseudocodeLine(4);
-        }
-    }
-    // End quick sort
-
-
-    // Merge sort
-    else if (currentAlgorithm == SortAlgorithm::Merge) {
-        if (!mergeStack.empty()) {
-            appendLog(QString("mergeStack size: %1").arg(mergeStack.size()));
-
-            if (!merging) {
-                auto [left, right, isMerge] = mergeStack.top();
-                mergeStack.pop();
-
-                if (!isMerge) {
-                    if (left < right) {
-                        int mid = (left + right) / 2;
-                        mergeStack.push({ left, right, true });       // merge phase
-                        mergeStack.push({ mid + 1, right, false });   // right half
-                        mergeStack.push({ left, mid, false });        // left half
-
-                        mergeLeftStartHistory.push_back(mergeLeftStart);
-                        mergeLeftEndHistory.push_back(mergeLeftEnd);
-                        mergeRightStartHistory.push_back(mergeRightStart);
-                        mergeRightEndHistory.push_back(mergeRightEnd);
-                        mergeMergedStartHistory.push_back(mergeMergedStart);
-                        mergeMergedEndHistory.push_back(mergeMergedEnd);
-
-                        pushFrame(array, -1, -1, -1);
-                    }
-                    return;
-                }
-
-                if (left >= right) {
-                    // Skip invalid merge
-                    return;
-                }
-
-                mergeLeft = left;
-                mergeRight = right;
-                mergeMid = (left + right) / 2;
-                mergeI = mergeLeft;
-                mergeJ = mergeMid + 1;
-                mergeK = mergeLeft;
-                merging = true;
-
-                mergeLeftStart = mergeLeft;
-                mergeLeftEnd = mergeMid;
-                mergeRightStart = mergeMid + 1;
-                mergeRightEnd = mergeRight;
-                mergeMergedStart = mergeLeft;
-                mergeMergedEnd = mergeRight;
-            }
-        }
-
-        // Merge step-by-step
-        if (merging) {
-            // highlight "merge" pseudocode line (line 4 in displayed list)
-            highlightPseudocodeLine(4);
-
-            if (mergeI <= mergeMid && mergeJ <= mergeRight) {
-                highlightComparison(mergeI, mergeJ, -1);
-                if (array[mergeI] <= array[mergeJ]) {
-                    mergeBuffer[mergeK++] = array[mergeI++];
-
-                    mergeLeftStartHistory.push_back(mergeLeftStart);
-                    mergeLeftEndHistory.push_back(mergeLeftEnd);
-                    mergeRightStartHistory.push_back(mergeRightStart);
-                    mergeRightEndHistory.push_back(mergeRightEnd);
-                    mergeMergedStartHistory.push_back(mergeMergedStart);
-                    mergeMergedEndHistory.push_back(mergeMergedEnd);
-
-                    pushFrame(array, -1, -1, -1);
-
-                }
-                else {
-                    mergeBuffer[mergeK++] = array[mergeJ++];
-
-                    mergeLeftStartHistory.push_back(mergeLeftStart);
-                    mergeLeftEndHistory.push_back(mergeLeftEnd);
-                    mergeRightStartHistory.push_back(mergeRightStart);
-                    mergeRightEndHistory.push_back(mergeRightEnd);
-                    mergeMergedStartHistory.push_back(mergeMergedStart);
-                    mergeMergedEndHistory.push_back(mergeMergedEnd);
-                    pushFrame(array, -1, -1, -1);
-                }
-            }
-            else if (mergeI <= mergeMid) {
-                highlightComparison(mergeI, -1, -1);
-                mergeBuffer[mergeK++] = array[mergeI++];
-
-                mergeLeftStartHistory.push_back(mergeLeftStart);
-                mergeLeftEndHistory.push_back(mergeLeftEnd);
-                mergeRightStartHistory.push_back(mergeRightStart);
-                mergeRightEndHistory.push_back(mergeRightEnd);
-                mergeMergedStartHistory.push_back(mergeMergedStart);
-                mergeMergedEndHistory.push_back(mergeMergedEnd);
-
-                pushFrame(array, -1, -1, -1);
+        switch (currentAlgorithm) {
+        case SortAlgorithm::Insertion:
+            showStep(s.x, -1, -1);
+            break;
+        case SortAlgorithm::Quick:
+            showStep(s.x, s.y, quickPartitioning ? quickPivot : s.y);
+            break;
+        case SortAlgorithm::Quick3:
+            if (!quickPartitioning) {
+                showStep(-1, s.x, s.y); // the chosen pivot moves to the right end
+                break;
             }
-else if (mergeJ <= mergeRight) {
-                highlightComparison(-1, mergeJ, -1);
-                mergeBuffer[mergeK++] = array[mergeJ++];
-
-                mergeLeftStartHistory.push_back(mergeLeftStart);
-                mergeLeftEndHistory.push_back(mergeLeftEnd);
-                mergeRightStartHistory.push_back(mergeRightStart);
-                mergeRightEndHistory.push_back(mergeRightEnd);
-                mergeMergedStartHistory.push_back(mergeMergedStart);
-                mergeMergedEndHistory.push_back(mergeMergedEnd);
-
-                pushFrame(array, -1, -1, -1);
+            // a smaller key went to lt (both boundaries advance), a larger one to gt
+            if (s.vx < quickPivotValue) {
+                quickPivot = s.x + 1;
+                quickI = s.y + 1;
             }
             else {
-                for (int i = mergeLeft; i <= mergeRight; ++i)
-                    array[i] = mergeBuffer[i];
-
-                highlightComparison(-1, -1, mergeK - 1);
-
-                mergeLeftStartHistory.push_back(mergeLeftStart);
-                mergeLeftEndHistory.push_back(mergeLeftEnd);
-                mergeRightStartHistory.push_back(mergeRightStart);
-                mergeRightEndHistory.push_back(mergeRightEnd);
-                mergeMergedStartHistory.push_back(mergeMergedStart);
-                mergeMergedEndHistory.push_back(mergeMergedEnd);
-
-                pushFrame(array, -1, -1, -1);
-
-                appendLog(QString("Merged [%1, %2]").arg(mergeLeft).arg(mergeRight));
-
-                // Reset merge state
-                mergeLeft = mergeMid = mergeRight = -1;
-                mergeI = mergeJ = mergeK = -1;
-                merging = false;
-
-                mergeLeftStart = mergeLeftEnd = -1;
-                mergeRightStart = mergeRightEnd = -1;
-                mergeMergedStart = mergeMergedEnd = -1;
-
-                if (mergeStack.empty()) {
-                    timer->stop();
-                    drawArrayFinished(array);
-                    appendLog("Merge Sort complete.");
-                    highlightPseudocodeLine(5); // finished
-                }
+                quickJ = s.x - 1;
             }
-        }
-    }    // End merge sort
-
-        // Heap sort
-
-    else if (currentAlgorithm == SortAlgorithm::Heap) {
-        if (heapBuilding) {
-            if (!heapStack.empty()) {
-                heapI = heapStack.top(); heapStack.pop();
-
-                int largest = heapI;
-                int left = 2 * heapI + 1;
-                int right = 2 * heapI + 2;
-
-                if (left  < heapSize && array[left]  > array[largest]) largest = left;
-                if (right < heapSize && array[right] > array[largest]) largest = right;
-
-                heapJ = largest;
-
-                // pseudocode: heapify step
-                highlightPseudocodeLine(1);
-
-                if (largest != heapI) {
-                    std::swap(array[heapI], array[largest]);
-                    heapStack.push(largest);
-                    appendLog(QString("Heapify swap at %1 with %2").arg(heapI).arg(largest));
-                }
-                else {
-                    appendLog(QString("Heapify compare at %1 (no swap)").arg(heapI));
-                }
-
-                // Live repaint and record frame
-                highlightComparison(heapI, heapJ, -1);
-
-                pushFrame(array, heapI, heapJ, -1);
-
-                if (stepMode) { timer->stop(); return; }
-                return;
+            showStep(quickI, quickJ, quickPivot);
+            break;
+        case SortAlgorithm::DualPivot:
+            if (!quickPartitioning) {
+                showStep(s.x, s.y, -1);
+                break;
             }
-            else {
-                // Transition to extraction
-                heapBuilding = false;
-                heapSwapping = true;
-                appendLog("Max-heap built. Starting extraction.");
-                // pseudocode: ready to extract
-                highlightPseudocodeLine(2);
-                return;
+            // A[k] went left to lt, or was swapped with gt; the pivots finally move in from the ends
+            if (s.x == dualLeft || s.x == dualRight) {
+                showStep(s.y, quickJ, quickPivot);
+                break;
             }
-        }
-
-        if (heapSwapping) {
-            if (heapStack.empty() && heapSize > 1) {
-
-                std::swap(array[0], array[heapSize - 1]);
-                sortedIndices.insert(heapSize - 1);
-
-                heapSize--;
-                heapStack.push(0);
-
-                heapI = 0;
-                heapJ = heapSize;
-
-                // pseudocode: extract max swap
-                highlightPseudocodeLine(2);
-
-                // Visualize extraction
-                highlightComparison(0, heapSize, -1);
-
-                appendLog(QString("Extracted max to index %1; heapSize=%2").arg(heapSize).arg(heapSize));
-
-                // Record this step
-                pushFrame(array, heapI, heapJ, -1);
-
-                if (stepMode) { timer->stop(); return; }
-                return;
+            if (s.x > s.y) quickJ = s.x - 1;
+            else quickPivot = s.x + 1;
+            showStep(quickI, quickJ, quickPivot);
+            break;
+        case SortAlgorithm::Merge:
+            if (smallRangeLeft >= 0) {
+                showStep(s.x, -1, -1);
+                break;
             }
-
-            // Re-heapify one node per tick
-            if (!heapStack.empty()) {
-                heapI = heapStack.top(); heapStack.pop();
-
-                int largest = heapI;
-                int left = 2 * heapI + 1;
-                int right = 2 * heapI + 2;
-
-                if (left  < heapSize && array[left]  > array[largest]) largest = left;
-                if (right < heapSize && array[right] > array[largest]) largest = right;
-
-                heapJ = largest;
-
-                // pseudocode: heapify step
-                highlightPseudocodeLine(1);
-
-                if (largest != heapI) {
-                    std::swap(array[heapI], array[largest]);
-                    heapStack.push(largest);
-                    appendLog(QString("Re-heapify swap at %1 with %2").arg(heapI).arg(largest));
-                }
-                else {
-                    appendLog(QString("Re-heapify compare at %1 (no swap)").arg(heapI));
-                }
-                highlightComparison(heapI, largest, -1);
-
-                pushFrame(array, heapI, heapJ, -1);
-
-                if (stepMode) { timer->stop(); return; }
-                return;
+            // everything up to the copied element is merged; the halves shrink from the left
+            mergeLeftStart = std::max(mergeLeftStart, s.x + 1);
+            mergeRightStart = std::max(mergeRightStart, s.x + 1);
+            showStep(s.x, -1, -1);
+            break;
+        case SortAlgorithm::Shell:
+            shellJ = s.x - gap;
+            showStep(shellI, s.x, -1);
+            break;
+        case SortAlgorithm::Tim:
+        case SortAlgorithm::BlockMerge:
+            if (timInserting) timJ = s.x - 1;
+            showStep(s.x, s.y, -1); // a rotation swaps two elements, everything else writes one
+            break;
+        case SortAlgorithm::NaturalMerge:
+            if (timInserting) {
+                timJ = s.x - 1;
             }
-
-            // Finalization when heap reduced to 0 or 1
-            if (heapSize <= 1 && heapStack.empty()) {
-                if (heapSize == 1) {
-                    sortedIndices.insert(0);
-                    heapSize = 0;
-                }
-
-                appendLog("Heap Sort complete.");
-                pushFrame(array, -1, -1, -1);
-
-                highlightComparison(-1, -1, -1);
-                drawArrayFinished(array);
-                if (timer) timer->stop();
-
-                // pseudocode: finished
-                highlightPseudocodeLine(3);
-                return;
+            else if (mergeLeftStart >= 0) {
+                // the merge is copied back in order; the runs shrink from the left
+                mergeLeftStart = std::max(mergeLeftStart, s.x + 1);
+                mergeRightStart = std::max(mergeRightStart, s.x + 1);
             }
-        }
-    }
-    // End heap sort
-
-
-    // Shell sort
-    else if (currentAlgorithm == SortAlgorithm::Shell) {
-        if (gap > 0) {
-            if (shellI < static_cast<int>(array.size())) {
-                if (!shellInserting) {
-                    shellKey = array[shellI];
-                    shellJ = shellI;
-                    shellInserting = true;
-
-                    appendLog(QString("Taking key = %1 at index %2").arg(shellKey).arg(shellI));
-
-                    // pseudocode: gapped insertion start
-                    highlightPseudocodeLine(1);
-
-                    highlightComparison(shellI, -1, -1);
-                    return;
-                }
-
-                if (shellJ >= gap && array[shellJ - gap] > shellKey) {
-                    appendLog(QString("Gap %1: shifting %2 right").arg(gap).arg(array[shellJ - gap]));
-                    array[shellJ] = array[shellJ - gap];
-                    shellJ -= gap;
-
-                    pushFrame(array, shellJ, shellJ + gap, -1);
-
-                    // pseudocode: shifting in gapped insertion
-                    highlightPseudocodeLine(2);
-
-                    highlightComparison(shellJ, shellJ + gap, -1);
-                    return;
-                }
-                else {
-                    array[shellJ] = shellKey;
-                    appendLog(QString("Inserted %1 at index %2").arg(shellKey).arg(shellJ));
-
-                    sortedIndices.insert(shellJ);
-                    shellInserting = false;
-
-                    // pseudocode: insertion done (mark)
-                    highlightPseudocodeLine(3);
-
-                    highlightComparison(shellJ, -1, -1);
-
-                    shellI++;
-                }
+            showStep(s.x, s.y, -1); // reversing a run swaps
+            break;
+        case SortAlgorithm::Bucket:
+            if (timInserting) {
+                showStep(s.x, -1, -1);
+                break;
             }
-            else {
-                gap /= 2;
-                shellI = gap;
-
-                // pseudocode: gap reduction
-                highlightPseudocodeLine(2);
+            radixPhase = RadixPhase::CopyBack;
+            radixIndex = s.x;
+            showStep(-1, -1, s.x);
+            break;
+        case SortAlgorithm::Radix:
+        case SortAlgorithm::Counting:
+            if (smallRangeLeft >= 0) {
+                showStep(s.x, s.y, -1);
+                break;
             }
+            radixPhase = RadixPhase::CopyBack;
+            radixIndex = s.x;
+            showStep(-1, -1, s.x);
+            break;
+        default:
+            showStep(s.x, s.y, -1);
+            break;
         }
-        else {
-            timer->stop();
-            appendLog("Shell Sort complete.");
-            for (int k = 0; k < array.size(); ++k) sortedIndices.insert(k);
-
-            shellI = -1;
-            shellJ = -1;
-            shellInserting = false;
-
-            highlightComparison(-1, -1, -1);
-
-            // pseudocode finished
-            highlightPseudocodeLine(3);
-        }
+        return true;
     }
-    // End shell sort
-
-
-    // TimSort (insertion then merge)
-    else if (currentAlgorithm == SortAlgorithm::Tim) {
-        if (timInserting) {
-            if (timStart < (int)array.size()) {
-                if (timI < timEnd) {
-                    // When we start working on a new key, ensure we log it.
-                    if (timJ == timI) {
-                        appendLog(QString("Run [%1, %2): taking key at index %3 (value %4)")
-                            .arg(timStart).arg(timEnd).arg(timI).arg(array[timI]));
-                    }
-
-                    if (timJ > timStart && array[timJ - 1] > timKey) {
-                        appendLog(QString("Shifting index %1 (value %2) right to %3").arg(timJ - 1).arg(array[timJ - 1]).arg(timJ));
-                        array[timJ] = array[timJ - 1];
-                        timJ--;
-
-                        pushFrame(array, timJ, timJ + 1, -1);
-
-                        // pseudocode: insertion in run
-                        highlightPseudocodeLine(1);
-
-                        highlightComparison(timJ, timJ + 1, -1);
-                        if (stepMode) { timer->stop(); return; }
-                        return;
-                    }
-                    else {
-                        // Insert key into its place and log it.
-                        array[timJ] = timKey;
-                        appendLog(QString("Inserted key %1 at index %2 (run [%3,%4))").arg(timKey).arg(timJ).arg(timStart).arg(timEnd));
-
-                        sortedIndices.insert(timJ);
-                        highlightComparison(timJ, -1, -1);
-
-                        timI++;
-                        timJ = timI;
-
-                        if (timI < timEnd) {
-                            timKey = array[timI];
-                            highlightComparison(timI, -1, -1);
-                        }
-                        else {
-                            // finished current run
-                            timRuns.push_back({ timStart, timEnd });
-                            appendLog(QString("Run sorted: [%1, %2)").arg(timStart).arg(timEnd));
-
-                            timStart = timEnd;
-                            timEnd = std::min(timStart + timRunSize, (int)array.size());
-
-                            // prepare next run's indices (if any)
-                            timI = timStart + 1;
-                            timJ = timI;
-                            timKey = (timI < timEnd) ? array[timI] : 0;
-
-                            // If we still have more runs to process, log it
-                            if (timStart < (int)array.size()) {
-                                appendLog(QString("Starting next run: [%1, %2)").arg(timStart).arg(timEnd));
-                                highlightComparison(timI, -1, -1);
-                            }
-                            else {
-                                // No more runs to insert-sort; switch to merging phase
-                                timInserting = false;
-                                timMerging = true;
-                                appendLog("All runs sorted. Starting merge phase.");
-                                highlightPseudocodeLine(2);
-                            }
-                        }
-                    }
-                }
-                else {
-                    // timI >= timEnd: finalize current run and prepare next
-                    timRuns.push_back({ timStart, timEnd });
-                    appendLog(QString("Run sorted: [%1, %2)").arg(timStart).arg(timEnd));
-
-                    timStart = timEnd;
-                    timEnd = std::min(timStart + timRunSize, (int)array.size());
-
-                    if (timStart < (int)array.size()) {
-                        timI = timStart + 1;
-                        timJ = timI;
-                        timKey = (timI < timEnd) ? array[timI] : 0;
-                        appendLog(QString("Starting next run: [%1, %2)").arg(timStart).arg(timEnd));
-                        highlightComparison(timI, -1, -1);
-                    }
-                    else {
-                        timInserting = false;
-                        timMerging = true;
-                        appendLog("All runs sorted. Starting merge phase.");
-                        highlightPseudocodeLine(2);
-                    }
-                }
-            }
-            else {
-                // no input left: switch to merging
-                timInserting = false;
-                timMerging = true;
-            }
-        }
-
-
-        else if (timMerging) {
-            if (timRuns.size() > 1) {
-
-                auto rightRun = timRuns.back(); timRuns.pop_back();
-                auto leftRun = timRuns.back(); timRuns.pop_back();
-
-                timLeft = leftRun.first;
-                timMid = leftRun.second;
-                timRight = rightRun.second;
-
-                appendLog(QString("Merging runs [%1,%2) and [%3,%4)").arg(timLeft).arg(timMid).arg(timMid).arg(timRight));
-
-                timMergeBuffer.assign(array.begin() + timLeft, array.begin() + timMid);
 
-                int i = 0;
-                int j = timMid;
-                int k = timLeft;
+    // a small range is finished by its own compares and writes; the next mark ends it
+    if (s.mark != SortMark::SmallRange) smallRangeLeft = smallRangeRight = -1;
 
-                while (i < (int)timMergeBuffer.size() && j < timRight) {
-                    if (timMergeBuffer[i] <= array[j]) {
-                        array[k++] = timMergeBuffer[i++];
-                    }
-                    else {
-                        array[k++] = array[j++];
-                    }
-
-                    pushFrame(array, i + timLeft, j, -1);
-
-                    highlightComparison(i + timLeft, j, -1);
-                    // pseudocode: merging runs
-                    highlightPseudocodeLine(2);
-                    if (stepMode) { timer->stop(); return; }
-                    return;
-                }
-
-                while (i < (int)timMergeBuffer.size()) {
-                    array[k++] = timMergeBuffer[i++];
-                }
-
-                for (int idx = timLeft; idx < timRight; ++idx)
-                    sortedIndices.insert(idx);
-
-                timRuns.push_back({ timLeft, timRight });
-                appendLog(QString("Merged runs into [%1, %2)").arg(timLeft).arg(timRight));
-            }
-            else {
-                timer->stop();
-
-                appendLog("TimSort complete.");
-                for (int k = 0; k < (int)array.size(); ++k) sortedIndices.insert(k);
-                highlightComparison(-1, -1, -1);
-                timMerging = false;
-
-                highlightPseudocodeLine(3);
-            }
-        }
-        }
-    // End TimSort
-
-
-    // Radix sort
-    else if (currentAlgorithm == SortAlgorithm::Radix) {
-        // Initialization
-        if (!radixInitialized) {
-            maxValue = *std::max_element(array.begin(), array.end());
-            digitPlace = 1;
-            radixPhase = RadixPhase::Count;
-            radixIndex = 0;
-            std::fill(count.begin(), count.end(), 0);
-            bucket.resize(array.size(), 0);
-            radixInitialized = true;
-
-            appendLog(QString("Radix Sort starting. maxValue=%1").arg(maxValue));
-            pushFrame(array, -1, -1, -1);
-
-            // pseudocode: outer loop init
-            highlightPseudocodeLine(0);
-            return;
-        }
-
-        // Counting phase
-        if (radixPhase == RadixPhase::Count) {
-            if (radixIndex < (int)array.size()) {
-                int digit = (array[radixIndex] / digitPlace) % 10;
-                count[digit]++;
-                // pseudocode: counting digits
-                highlightPseudocodeLine(1);
-
-                highlightComparison(radixIndex, -1, -1);
-                pushFrame(array, radixIndex, -1, -1);
-
-                appendLog(QString("Counting digit %1 at index %2")
-                    .arg(digit).arg(radixIndex));
-
-                radixIndex++;
-                return;
-            }
-            else {
-                radixPhase = RadixPhase::Accumulate;
-                radixIndex = 0;
-                appendLog("Switching to Accumulate phase.");
-                return;
-            }
+    switch (s.mark) {
+    case SortMark::Key:
+        appendLog(QString("Taking key %1 at index %2.").arg(array[s.x]).arg(s.x));
+        if (currentAlgorithm == SortAlgorithm::Shell) {
+            shellI = shellJ = s.x;
+            shellInserting = true;
         }
-
-        // Accumulate phase
-        if (radixPhase == RadixPhase::Accumulate) {
-            if (radixIndex < 9) {
-                count[radixIndex + 1] += count[radixIndex];
-                // pseudocode: accumulate
-                highlightPseudocodeLine(2);
-
-                highlightComparison(-1, radixIndex, -1);
-                pushFrame(array, -1, radixIndex, -1);
-
-                appendLog(QString("Accumulating bucket %1").arg(radixIndex));
-
-                radixIndex++;
-                return;
-            }
-            else {
-                radixPhase = RadixPhase::Place;
-                radixIndex = (int)array.size() - 1;
-                appendLog("Switching to Placement phase.");
-                return;
-            }
+        if (currentAlgorithm == SortAlgorithm::Tim || currentAlgorithm == SortAlgorithm::BlockMerge
+            || currentAlgorithm == SortAlgorithm::NaturalMerge)
+            timI = timJ = s.x;
+        showStep(s.x, -1, -1);
+        return true;
+
+    case SortMark::Partition:
+        quickRight = s.y;
+        quickPivot = s.z;
+        quickPivotValue = array[s.z];
+        quickPartitioning = true;
+        if (currentAlgorithm == SortAlgorithm::Quick3) {
+            quickPivot = quickI = s.x; // lt and i start at the left end, gt at the right
+            quickJ = s.y;
         }
+        appendLog(QString("Partitioning [%1, %2] around pivot %3.").arg(s.x).arg(s.y).arg(array[s.z]));
+        return false;
+
+    case SortMark::PivotPlaced:
+        markSorted(s.x);
+        quickPivot = s.x;
+        quickPartitioning = false;
+        dualLeft = dualRight = -1;
+        appendLog(QString("Placed pivot %1 at index %2.").arg(array[s.x]).arg(s.x));
+        return false;
+
+    case SortMark::MergeBegin:
+        mergeLeftStart = mergeMergedStart = s.x;
+        mergeLeftEnd = s.y - 1;
+        mergeRightStart = s.y;
+        mergeRightEnd = mergeMergedEnd = s.z - 1;
+        timInserting = false;
+        rotateFirst = rotateMiddle = rotateLast = -1;
+        appendLog(QString("Merging [%1, %2) with [%2, %3).").arg(s.x).arg(s.y).arg(s.z));
+        return false;
+
+    case SortMark::Rotate:
+        timInserting = false;
+        rotateFirst = s.x;
+        rotateMiddle = s.y;
+        rotateLast = s.z;
+        appendLog(QString("Too big for the buffer: rotating [%1, %2) past [%2, %3), %4 swaps.")
+                      .arg(s.x).arg(s.y).arg(s.z).arg((s.y - s.x) / 2 + (s.z - s.y) / 2 + (s.z - s.x) / 2));
+        return false;
+
+    case SortMark::NaturalRun:
+        timInserting = false;
+        naturalRunStart = s.x;
+        naturalRunEnd = s.y;
+        if (s.z == 1)
+            appendLog(QString("Found a descending run [%1, %2); reversing it.").arg(s.x).arg(s.y));
+        else
+            appendLog(QString("Found an ascending run [%1, %2).").arg(s.x).arg(s.y));
+        return false;
+
+    case SortMark::MergePass:
+        timInserting = false;
+        naturalRunStart = naturalRunEnd = -1;
+        naturalRunsLeft = s.x;
+        appendLog(QString("Merge pass over %1 runs.").arg(s.x));
+        return false;
+
+    case SortMark::MergeRuns: {
+        timInserting = false;
+        timMerging = true;
+        timLeft = s.x;
+        timMid = -1;
+        timRight = s.y;
+        timRunWidth = s.z;
+        const int runs = (s.y - s.x + s.z - 1) / s.z;
+        int depth = 0;
+        while ((1 << depth) < runs) ++depth;
+        appendLog(QString("Merging the %1 runs of [%2, %3) at once: a loser tree plays %4 matches per element.")
+                      .arg(runs).arg(s.x).arg(s.y).arg(depth));
+        return false;
+    }
+
+    case SortMark::MergeEnd:
+        mergeLeftStart = mergeLeftEnd = mergeRightStart = mergeRightEnd = -1;
+        mergeMergedStart = mergeMergedEnd = -1;
+        appendLog(QString("Merged [%1, %2).").arg(s.x).arg(s.y));
+        return false;
 
-        // Placement phase
-        if (radixPhase == RadixPhase::Place) {
-            if (radixIndex >= 0) {
-                int digit = (array[radixIndex] / digitPlace) % 10;
-                bucket[count[digit] - 1] = array[radixIndex];
-                count[digit]--;
-                // pseudocode: place into bucket
-                highlightPseudocodeLine(3);
-
-                highlightComparison(radixIndex, -1, -1);
-                pushFrame(array, radixIndex, -1, -1);
-
-                appendLog(QString("Placing value %1 (digit %2) into bucket[%3]")
-                    .arg(array[radixIndex])
-                    .arg(digit)
-                    .arg(count[digit]));
-
+    case SortMark::Sorted:
+        markSortedRange(s.x, s.y);
+        if (s.y - s.x == 1) appendLog(QString("Index %1 holds its final value.").arg(s.x));
+        return false;
 
-                radixIndex--;
-                return;
-            }
-            else {
-                radixPhase = RadixPhase::CopyBack;
-                radixIndex = 0;
-                appendLog("Switching to CopyBack phase.");
-                return;
-            }
-        }
+    case SortMark::Run:
+        timInserting = true;
+        timMerging = false;
+        radixIndex = -1;
+        if (currentAlgorithm == SortAlgorithm::NaturalMerge) naturalRunEnd = s.y; // the short run grows to s.y
+        appendLog(QString("Insertion-sorting %1 [%2, %3).").arg(currentAlgorithm == SortAlgorithm::Bucket ? "bucket" : "run").arg(s.x).arg(s.y));
+        return false;
 
-        // CopyBack phase
-        if (radixPhase == RadixPhase::CopyBack) {
-            if (radixIndex < (int)array.size()) {
-                array[radixIndex] = bucket[radixIndex];
-                // pseudocode: copy back
-                highlightPseudocodeLine(4);
+    case SortMark::Gap:
+        gap = s.x;
+        shellInserting = false;
+        appendLog(QString("Gap = %1.").arg(s.x));
+        return false;
 
-                highlightComparison(-1, -1, radixIndex);
-                pushFrame(array, -1, -1, radixIndex);
+    case SortMark::HeapBuilt:
+        heapBuilding = false;
+        appendLog("Max-heap built. Starting extraction.");
+        return false;
 
-                appendLog(QString("Copying back value %1 to index %2")
-                    .arg(array[radixIndex]).arg(radixIndex));
+    case SortMark::DigitPass:
+        appendLog(QString("Sorting by digit place %1.").arg(s.x));
+        return false;
 
-                radixIndex++;
-                return;
-            }
-            else {
-                digitPlace *= 10;
-                if (digitPlace <= maxValue) {
-                    radixPhase = RadixPhase::Count;
-                    radixIndex = 0;
-                    std::fill(count.begin(), count.end(), 0);
-                    std::fill(bucket.begin(), bucket.end(), 0);
-
-                    appendLog(QString("Next digit place: %1").arg(digitPlace));
-                    return;
-                }
-                else {
-                    timer->stop();
-                    drawArrayFinished(array);
-                    appendLog("Radix Sort complete.");
-                    // pseudocode finished
-                    highlightPseudocodeLine(5);
-                }
-            }
+    case SortMark::CountDigit:
+        radixPhase = RadixPhase::Count;
+        radixIndex = s.x;
+        if (currentAlgorithm == SortAlgorithm::Counting)
+            appendLog(QString("Counting key %1 at index %2.").arg(array[s.x]).arg(s.x));
+        else if (currentAlgorithm == SortAlgorithm::Bucket)
+            appendLog(QString("Index %1 (%2) belongs to bucket %3.").arg(s.x).arg(array[s.x]).arg(s.y));
+        else
+            appendLog(QString("Counting digit %1 at index %2.").arg(s.y).arg(s.x));
+        showStep(s.x, -1, -1);
+        return true;
+
+    case SortMark::Accumulate:
+        radixPhase = RadixPhase::Accumulate;
+        radixIndex = s.x;
+        appendLog(QString("Accumulating bucket %1.").arg(s.x));
+        showStep(-1, s.x, -1);
+        return true;
+
+    case SortMark::Place:
+        radixPhase = RadixPhase::Place;
+        radixIndex = s.x;
+        appendLog(QString("Placing value %1 into bucket slot %2.").arg(array[s.x]).arg(s.y));
+        showStep(s.x, -1, -1);
+        return true;
+
+    case SortMark::EqualRange:
+        markSortedRange(s.x, s.y);
+        quickI = quickJ = quickPivot = -1;
+        quickPartitioning = false;
+        if (currentAlgorithm == SortAlgorithm::DualPivot) {
+            dualLeft = dualRight = -1;
+            dualGathering = false;
+            if (s.x < s.y)
+                appendLog(QString("Keys equal to pivot %1 fill [%2, %3) and are final.").arg(array[s.x]).arg(s.x).arg(s.y));
+            return false;
         }
+        appendLog(QString("Keys equal to the pivot (%1) fill [%2, %3) and are final.").arg(quickPivotValue).arg(s.x).arg(s.y));
+        return false;
+
+    case SortMark::PivotChosen:
+        quickPivot = s.x;
+        quickRight = s.y;
+        if (currentAlgorithm == SortAlgorithm::DualPivot)
+            appendLog(QString("Chose index %1 (%2) as a pivot, moved to index %3.").arg(s.x).arg(array[s.x]).arg(s.y));
+        else
+            appendLog(QString("Chose index %1 (%2) as the pivot.").arg(s.x).arg(array[s.x]));
+        return false;
+
+    case SortMark::DualPartition:
+        dualLeft = s.x;
+        dualRight = s.y;
+        dualGathering = s.z == 1;
+        quickPartitioning = true;
+        quickPivot = quickI = s.x + 1; // lt and k start next to the left pivot, gt next to the right one
+        quickJ = s.y - 1;
+        appendLog(dualGathering ? QString("The middle part (%1, %2) is large: gathering the keys equal to the pivots %3 and %4.")
+                                      .arg(s.x).arg(s.y).arg(array[s.x]).arg(array[s.y])
+                                : QString("Partitioning [%1, %2] around pivots %3 and %4.").arg(s.x).arg(s.y).arg(array[s.x]).arg(array[s.y]));
+        return false;
+
+    case SortMark::DualRegions:
+        quickPivot = s.x;
+        quickI = s.y;
+        quickJ = s.z;
+        return false;
+
+    case SortMark::NetworkLayer: {
+        // the layer's comparators are contiguous, since the list is ordered by layer
+        std::fill(networkLayerWires.begin(), networkLayerWires.end(), 0);
+        auto first = std::lower_bound(networkComparators.begin(), networkComparators.end(), s.x,
+                                      [](const SortEngine::NetworkComparator& c, int layer) { return c.layer < layer; });
+        int count = 0;
+        for (auto it = first; it != networkComparators.end() && it->layer == s.x; ++it, ++count)
+            networkLayerWires[it->a] = networkLayerWires[it->b] = 1;
+        appendLog(QString("Layer %1 of %2: %3 independent compare-exchanges.").arg(s.x + 1).arg(s.y).arg(count));
+        return false;
+    }
+
+    case SortMark::BitonicStage:
+        bitonicHalf = s.y;
+        bitonicMirrored = s.z == 1;
+        appendLog(s.z == 1 ? QString("Merging blocks of %1: every element against its mirror.").arg(s.x)
+                           : QString("Blocks of %1: half cleaner at distance %2.").arg(s.x).arg(s.y));
+        return false;
+
+    case SortMark::SmallRange:
+        smallRangeLeft = s.x;
+        smallRangeRight = s.y;
+        quickI = quickJ = quickPivot = -1;
+        quickPartitioning = false;
+        appendLog(QString("[%1, %2) has only %3 elements: finishing it with %4.")
+                      .arg(s.x).arg(s.y).arg(s.y - s.x).arg(s.z == 2 ? "the SIMD kernel (shown as its scalar network)" : s.z == 1 ? "a sorting network" : "insertion sort"));
+        return false;
     }
-    // End radix sort
-
+    return false;
+}
 
-    // Gnome sort
-    else if (currentAlgorithm == SortAlgorithm::Gnome) {
-        if (gnomeIndex < array.size()) {
-            int index1 = gnomeIndex;
-            int index2 = gnomeIndex - 1;
+// Pseudocode line (0-based, as listed in onAlgorithmSelected) for an event; -1 keeps the current one.
+int MainWindow::pseudocodeLine(const SortEngine::SortStep& s) const {
+    using Kind = SortEngine::SortStep::Kind;
+    const bool compare = s.kind == Kind::Compare;
+    const bool write = s.kind == Kind::Write;
+    auto is = [&s](SortMark m) { return s.kind == Kind::Mark && s.mark == m; };
+
+    if (is(SortMark::SmallRange) || (smallRangeLeft >= 0 && (compare || write))) return pseudocodeView->count() - 1;
+
+    switch (currentAlgorithm) {
+    case SortAlgorithm::Bubble:    return compare ? 2 : write ? 3 : -1;
+    case SortAlgorithm::Insertion: return is(SortMark::Key) ? 1 : compare ? 2 : write ? 3 : -1;
+    case SortAlgorithm::Selection: return compare ? 3 : write ? 4 : is(SortMark::Sorted) ? 1 : -1;
+    case SortAlgorithm::Quick:
+        // before the Partition mark, compares and the one swap belong to choosing the pivot
+        if (is(SortMark::PivotChosen) || (!quickPartitioning && (compare || write))) return 1;
+        return is(SortMark::Partition) ? 1 : compare ? 3 : write ? (s.y == quickRight ? 5 : 4) : -1;
+    case SortAlgorithm::Quick3:
+        if (is(SortMark::PivotChosen) || (!quickPartitioning && (compare || write))) return 0;
+        if (is(SortMark::Partition)) return 1;
+        if (is(SortMark::EqualRange)) return 6;
+        return compare ? 2 : write ? (s.vx < quickPivotValue ? 3 : 4) : -1;
+    case SortAlgorithm::DualPivot:
+        if (is(SortMark::PivotChosen) || (!quickPartitioning && (compare || write))) return 0;
+        if (is(SortMark::DualPartition)) return s.z == 1 ? 9 : 1;
+        if (is(SortMark::EqualRange) || (dualGathering && (compare || write || is(SortMark::DualRegions)))) return 9;
+        if (is(SortMark::PivotPlaced)) return 8;
+        if (is(SortMark::DualRegions)) return 2;
+        if (compare) return s.x != quickI ? 5 : s.y == dualLeft ? 3 : 4;
+        if (write) return (s.x == dualLeft || s.x == dualRight) ? 8 : s.x > s.y ? 6 : 3;
+        return -1;
+    case SortAlgorithm::Merge:     return (is(SortMark::MergeBegin) || compare || write) ? 5 : -1;
+    case SortAlgorithm::Heap:      return (compare || write) ? (heapBuilding ? 1 : 4) : is(SortMark::HeapBuilt) ? 2 : -1;
+    case SortAlgorithm::Shell:     return is(SortMark::Gap) ? 1 : is(SortMark::Key) ? 3 : compare ? 4 : write ? 5 : -1;
+    case SortAlgorithm::Tim:
+        if (is(SortMark::Run) || is(SortMark::Key)) return 1;
+        if (is(SortMark::MergeRuns)) return 2;
+        return (compare || write) ? (timMerging ? 2 : 1) : -1;
+    case SortAlgorithm::BlockMerge:
+        if (is(SortMark::Run) || is(SortMark::Key) || (timInserting && (compare || write))) return 0;
+        if (is(SortMark::MergeBegin) || (mergeLeftStart >= 0 && (compare || write))) return 3;
+        if (is(SortMark::Rotate) || write) return 5;
+        return compare ? (s.y == s.x + 1 ? 2 : 4) : -1;
+    case SortAlgorithm::NaturalMerge:
+        if (is(SortMark::Run) || is(SortMark::Key) || (timInserting && (compare || write))) return 2;
+        if (is(SortMark::MergePass)) return 3;
+        if (naturalRunsLeft == 0) return (is(SortMark::NaturalRun) || compare) ? 0 : write ? 1 : -1;
+        if (is(SortMark::MergeBegin) || (mergeLeftStart >= 0 && (compare || write))) return 6;
+        return compare ? (s.y == s.x + 1 ? 4 : 5) : -1;
+    case SortAlgorithm::Radix:
+        if (is(SortMark::DigitPass)) return 1;
+        return (write || is(SortMark::CountDigit) || is(SortMark::Accumulate) || is(SortMark::Place)) ? 2 : -1;
+    case SortAlgorithm::Gnome:     return compare ? 2 : write ? 5 : -1;
+    case SortAlgorithm::Network:   return is(SortMark::NetworkLayer) ? 1 : compare ? 3 : write ? 4 : -1;
+    case SortAlgorithm::Bitonic:
+        if (is(SortMark::BitonicStage)) return s.z == 1 ? 1 : 3;
+        return (compare || write) ? (bitonicMirrored ? 1 : 3) : -1;
+    case SortAlgorithm::Counting:
+        // a wide key range runs radix sort, all of it on the first line
+        if (is(SortMark::DigitPass) || is(SortMark::Accumulate) || is(SortMark::Place)) return 0;
+        return is(SortMark::CountDigit) ? 1 : write ? 3 : -1;
+    case SortAlgorithm::Bucket:
+        if (is(SortMark::Run) || is(SortMark::Key) || (timInserting && (compare || write))) return 4;
+        return is(SortMark::CountDigit) ? 1 : is(SortMark::Accumulate) ? 2 : (is(SortMark::Place) || write) ? 3 : -1;
+    }
+    return -1;
+}
 
-            if (gnomeIndex == 0 || array[index1] >= array[index2]) {
-                gnomeIndex++;
-                // pseudocode: advancing
-                highlightPseudocodeLine(2);
-            }
-            else {
-                std::swap(array[index1], array[index2]);
-                gnomeIndex--;
-                // pseudocode: swap
-                highlightPseudocodeLine(3);
-            }
+// Records the current array as a frame and draws it the way scrubbing to that frame would.
+void MainWindow::showStep(int index1, int index2, int pivot) {
+    pushFrame(array, index1, index2, pivot);
+    if (recordingOnly) return;
 
-            highlightComparison(index1, index2, -1);
+    drawArray(array);
+    highlightFrame(index1, index2, pivot);
+    setStep(QString("Step %1").arg(history.size() - 1));
+}
 
-            pushFrame(array, index1, index2, -1);
+void MainWindow::highlightFrame(int index1, int index2, int pivot) {
+    if (currentAlgorithm == SortAlgorithm::Quick) {
+        quickPivot = pivot;
+        quickI = index1;
+        quickJ = index2;
 
-            appendLog(QString("Comparing indices %1 and %2").arg(index1).arg(index2));
-            return;
-        }
-        else {
-            timer->stop();
-            drawArrayFinished(array);
-            appendLog("Gnome Sort complete.");
-            highlightPseudocodeLine(4);
-        }
+        highlightComparison(index2, quickPivot, quickPivot);
+    }
+    else if (currentAlgorithm == SortAlgorithm::Quick3) {
+        // frames hold i, gt and lt: everything in [lt, i) equals the pivot
+        quickI = index1;
+        quickJ = index2;
+        quickPivot = pivot;
+        highlightComparison(index1, index2, pivot);
+    }
+    else if (currentAlgorithm == SortAlgorithm::DualPivot) {
+        // while partitioning, frames hold k, gt and lt; the pivots sit at dualLeft and dualRight
+        quickI = index1;
+        quickJ = index2;
+        quickPivot = pivot;
+        highlightComparison(index1, index2, pivot);
+    }
+    else if (currentAlgorithm == SortAlgorithm::Merge || currentAlgorithm == SortAlgorithm::Heap) {
+        highlightComparison(index1, index2, pivot);
+    }
+    // General fallback: highlight whatever the frame recorded
+    else if (index1 != -1 || index2 != -1 || pivot != -1) {
+        highlightComparison(index1, index2, pivot);
     }
-    // End gnome sort
 }
 
-void MainWindow::updateScene() {
-    scene->clear();
-
-    if (array.empty()) return;
-
-    int maxVal = *std::max_element(array.begin(), array.end());
-    int maxBarHeight = 150;
-    int x = 10;
-
-    const QSet<int>* activeSorted = displayedSortedIndices.isEmpty() ? &sortedIndices : &displayedSortedIndices;
-
+SortOptions MainWindow::currentSortOptions() const {
+    SortOptions options;
+    pivotStrategyFromName(pivotBox->currentText().toStdString(), options.pivot);
+    heapVariantFromName(heapBox->currentText().toStdString(), options.heap);
+    gapSequenceFromName(gapBox->currentText().toStdString(), options.gaps);
+    options.cutoff = cutoffSpinBox->value();
+    smallSortFromName(smallSortBox->currentText().toStdString(), options.smallSort);
+    return options;
+}
 
-    for (size_t index = 0; index < array.size(); ++index) {
-        int val = array[index];
-        int barHeight = (maxVal > 0) ? (val * maxBarHeight / maxVal) : 0;
+void MainWindow::onTuneCutoffClicked() {
+    SortAlgorithm alg;
+    if (!algorithmFromName(algorithmBox->currentText().toStdString(), alg)) return;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    std::vector<CutoffTiming> timings;
+    int best = tuneCutoff(alg, currentSortOptions(), &timings);
+    QApplication::restoreOverrideCursor();
+
+    QStringList parts;
+    for (const CutoffTiming& t : timings)
+        parts << QString("%1: %2 ms").arg(t.cutoff > 0 ? QString::number(t.cutoff) : QString("off")).arg(t.ms, 0, 'f', 2);
+    appendLog(QString("Cutoff timings for %1 on random input: %2.").arg(algorithmName(alg), parts.join(", ")));
+    appendLog(best > 0 ? QString("Fastest cutoff on this CPU: %1.").arg(best) : QString("Fastest without a cutoff."));
+    cutoffSpinBox->setValue(best);
+}
 
-        QColor color = Qt::blue;
+void MainWindow::resetDisplayState() {
+    runSteps.clear();
+    runPos = 0;
+
+    quickI = quickJ = quickPivot = quickRight = -1;
+    quickPivotValue = 0;
+    quickPartitioning = false;
+    dualLeft = dualRight = -1;
+    dualGathering = false;
+    smallRangeLeft = smallRangeRight = -1;
+    networkLayerWires.clear();
+    bitonicHalf = 0;
+    bitonicMirrored = false;
+    mergeLeftStart = mergeLeftEnd = mergeRightStart = mergeRightEnd = mergeMergedStart = mergeMergedEnd = -1;
+    heapBuilding = false;
+    gap = 0;
+    shellI = shellJ = -1;
+    shellInserting = false;
+    timI = timJ = timLeft = timMid = timRight = -1;
+    timRunWidth = 0;
+    timInserting = timMerging = false;
+    rotateFirst = rotateMiddle = rotateLast = -1;
+    naturalRunStart = naturalRunEnd = -1;
+    naturalRunsLeft = 0;
+    radixIndex = -1;
+    radixPhase = RadixPhase::Count;
+}
 
-        // Optional: highlight logic (minimal)
-        if (currentAlgorithm == SortAlgorithm::Bubble && (index == i || index == j)) {
-            color = Qt::red;
-        }
-        else if (currentAlgorithm == SortAlgorithm::Quick && index == quickPivot) {
-            color = Qt::yellow;
-        }
-        else if (activeSorted->contains(static_cast<int>(index))) {
-            color = Qt::green;
-        }
+void MainWindow::finishRun() {
+    timer->stop();
 
-        scene->addRect(x, 200 - barHeight, 20, barHeight, QPen(Qt::black), QBrush(color));
+    shellInserting = timInserting = timMerging = false;
+    smallRangeLeft = smallRangeRight = -1;
+    networkLayerWires.clear();
+    bitonicHalf = 0;
+    mergeLeftStart = mergeLeftEnd = mergeRightStart = mergeRightEnd = mergeMergedStart = mergeMergedEnd = -1;
+    markSortedRange(0, static_cast<int>(array.size()));
 
-        QGraphicsTextItem* text = scene->addText(QString::number(val));
-        text->setPos(x, 200 + 5);
-        text->setDefaultTextColor(QColor("#DFDFDF"));
+    appendLog(QString("%1 complete.").arg(algorithmName(currentAlgorithm)));
+    appendLog("Array is sorted.");
+    highlightPseudocodeLine(-1);
+    drawArrayFinished(array);
+}
 
-        x += 30;
-    }
+void MainWindow::updateScene() {
+    view->update();
 }
 
 void MainWindow::setStep(const QString& msg) {
@@ -2114,74 +2140,55 @@ void MainWindow::setStep(const QString& msg) {
 }
 
 void MainWindow::appendLog(const QString& msg) {
+    if (recordingOnly) return;
     logView->appendPlainText(msg);
 }
 
 void MainWindow::drawArray(const std::vector<int>& arr) {
-    scene->clear();
-
-    if (arr.empty()) return;
-
-    int maxVal = *std::max_element(arr.begin(), arr.end());
-    int maxBarHeight = 150;
-
-    int x = 10;
-    for (int val : arr) {
-        int barHeight = (maxVal > 0) ? (val * maxBarHeight / maxVal) : 0;
+    if (recordingOnly) return;
 
-        QColor barColor = darkModeEnabled
+    barMode = BarMode::Plain;
+    view->setNeutralColor(darkModeEnabled
                               ? QColor(30, 144, 255)   // light blue for dark mode
-                              : QColor(65, 105, 225);   // royal blue for light mode
-
-        scene->addRect(x, 200 - barHeight, 20, barHeight, QPen(Qt::black), QBrush(barColor));
-
-        QGraphicsTextItem* text = scene->addText(QString::number(val));
-        text->setPos(x, 200 + 5);
-        text->setDefaultTextColor(QColor("#DFDFDF"));
-
-        x += 30;
-
-    }
-    scene->update();
+                              : QColor(65, 105, 225)); // royal blue for light mode
+    view->setHeader(QString());
+    view->setValues(&arr);
+    view->update();
 }
 
 void MainWindow::drawArrayFinished(const std::vector<int>& arr) {
+    if (recordingOnly) return;
 
-    scene->clear();
-
-    if (arr.empty()) return;
-
-    int maxVal = *std::max_element(array.begin(), array.end());
-    int maxBarHeight = 150;
-
-    int x = 10;
-    for (int val : arr) {
-        int barHeight = (maxVal > 0) ? (val * maxBarHeight / maxVal) : 0;
-        scene->addRect(x, 200 - barHeight, 20, barHeight, QPen(Qt::black), QBrush(Qt::green));
-
-        QGraphicsTextItem* text = scene->addText(QString::number(val));
-        text->setPos(x, 200 + 5);
-        text->setDefaultTextColor(QColor("#DFDFDF"));
-
-        x += 30;
-    }
+    barMode = BarMode::Finished;
+    view->setNeutralColor(QColor(0, 255, 0));
+    view->setHeader(QString());
+    view->setValues(&arr);
+    view->update();
 }
 
 void MainWindow::highlightComparison(int index1, int index2, int pivotIndex /* = -1 */) {
-    scene->clear();
+    if (recordingOnly) return;
 
-    if (array.empty()) return;
+    barMode = BarMode::Highlight;
+    highlightIndex1 = index1;
+    highlightIndex2 = index2;
+    highlightPivot = pivotIndex;
 
-    int maxVal = *std::max_element(array.begin(), array.end());
-    int maxBarHeight = 150;
-    int x = 10;
+    view->setNeutralColor(QColor(200, 200, 200));
+    view->setValues(&array);
 
-    const QSet<int>* activeSorted = displayedSortedIndices.isEmpty() ? &sortedIndices : &displayedSortedIndices;
+    if (array.empty()) {
+        view->setHeader(QString());
+        view->update();
+        return;
+    }
 
     // Build a concise step description to display above the bars.
     QString stepMsg;
-    // Radix has distinct phases
-    if (currentAlgorithm == SortAlgorithm::Radix) {
+    // Radix has distinct phases, and so do counting sort and bucket sort until the buckets are sorted
+    const bool radixPhases = currentAlgorithm == SortAlgorithm::Radix || currentAlgorithm == SortAlgorithm::Counting ||
+                             (currentAlgorithm == SortAlgorithm::Bucket && !timInserting);
+    if (radixPhases) {
         switch (radixPhase) {
         case RadixPhase::Count:
             if (index1 >= 0 && index1 < (int)array.size())
@@ -2218,6 +2225,20 @@ void MainWindow::highlightComparison(int index1, int index2, int pivotIndex /* =
         else if (index1 >= 0 && index2 >= 0)
             stepMsg = QString("Comparing index %1 (%2) and %3 (%4)").arg(index1).arg(array[index1]).arg(index2).arg(array[index2]);
     }
+    else if (currentAlgorithm == SortAlgorithm::Quick3) {
+        if (index1 >= 0 && index1 < (int)array.size() && pivotIndex >= 0)
+            stepMsg = QString("Checking index %1 (%2) against pivot %3; %4 equal keys so far")
+                          .arg(index1).arg(array[index1]).arg(quickPivotValue).arg(std::max(0, index1 - pivotIndex));
+    }
+    else if (currentAlgorithm == SortAlgorithm::DualPivot) {
+        if (dualLeft >= 0 && index1 >= 0 && index1 < (int)array.size())
+            stepMsg = QString("Pivots %1 and %2: %3 left, %4 middle, %5 right; checking index %6 (%7)")
+                          .arg(array[dualLeft]).arg(array[dualRight]).arg(std::max(0, pivotIndex - dualLeft - 1))
+                          .arg(std::max(0, index1 - pivotIndex)).arg(std::max(0, dualRight - index2 - 1))
+                          .arg(index1).arg(array[index1]);
+        else if (index1 >= 0 && index2 >= 0 && index1 < (int)array.size() && index2 < (int)array.size())
+            stepMsg = QString("Comparing index %1 (%2) and %3 (%4)").arg(index1).arg(array[index1]).arg(index2).arg(array[index2]);
+    }
     // Merge: show merging range if available
     else if (currentAlgorithm == SortAlgorithm::Merge) {
         if (mergeLeftStart >= 0 && mergeMergedEnd >= 0)
@@ -2248,123 +2269,210 @@ void MainWindow::highlightComparison(int index1, int index2, int pivotIndex /* =
         }
     }
 
-    // Display the step description above the array (as a scene text item)
-    if (!stepMsg.isEmpty()) {
-        QGraphicsTextItem* header = scene->addText(stepMsg);
-        QFont f = header->font();
-        f.setBold(true);
-        header->setFont(f);
-        header->setDefaultTextColor(QColor("#DFDFDF"));
-        header->setPos(10, 200 - maxBarHeight - 24);
+    // Display the step description above the array. Paint now: the colours read live
+    // algorithm state that the rest of this tick may still change.
+    view->setHeader(stepMsg);
+    view->repaint();
+}
 
-    }
+// Colour of bar k for the current draw mode; called by the view only for bars on screen.
+QColor MainWindow::barColor(int k) const {
+    if (barMode == BarMode::Plain)
+        return darkModeEnabled ? QColor(30, 144, 255) : QColor(65, 105, 225);
+    if (barMode == BarMode::Finished)
+        return QColor(0, 255, 0);
 
-    for (int k = 0; k < array.size(); ++k) {
-        int barHeight = (maxVal > 0) ? (array[k] * maxBarHeight / maxVal) : 0;
+    const int index1 = highlightIndex1;
+    const int index2 = highlightIndex2;
+    const int pivotIndex = highlightPivot;
+    const SortedIndexSet* activeSorted = displayedSortedIndices.isEmpty() ? &sortedIndices : &displayedSortedIndices;
 
-        // Neutral base color for all bars
-        QColor color = QColor(200, 200, 200);
+    // Neutral base color for all bars
+    QColor color = QColor(200, 200, 200);
 
-        if (currentAlgorithm == SortAlgorithm::Merge) {
-            if (k >= mergeLeftStart && k <= mergeLeftEnd)
-                color = QColor(0, 255, 255);
-            else if (k >= mergeRightStart && k <= mergeRightEnd)
-                color = QColor(255, 20, 147);
-            else if (k >= mergeMergedStart && k <= mergeMergedEnd)
-                color = QColor(0, 255, 0);
-        }
-
-        if (currentAlgorithm == SortAlgorithm::Quick) {
-            if (k == pivotIndex && pivotIndex >= 0)
-                color = QColor(186, 85, 211);
-            else if (k == index1 || k == index2)
-                color = QColor(30, 144, 255);
-            else if (activeSorted->contains(k))
-                color = QColor(0, 255, 0);
-        }
+    if (currentAlgorithm == SortAlgorithm::Merge) {
+        if (k >= mergeLeftStart && k <= mergeLeftEnd)
+            color = QColor(0, 255, 255);
+        else if (k >= mergeRightStart && k <= mergeRightEnd)
+            color = QColor(255, 20, 147);
+        else if (k >= mergeMergedStart && k <= mergeMergedEnd)
+            color = QColor(0, 255, 0);
+    }
 
-        if (currentAlgorithm == SortAlgorithm::Heap) {
-            if (k == index1)
-                color = QColor(255, 165, 0);
-            else if (k == index2)
-                color = QColor(255, 0, 0);
-            else if (activeSorted->contains(k))
-                color = QColor(0, 255, 0);
-        }
+    if (currentAlgorithm == SortAlgorithm::Quick) {
+        if (k == pivotIndex && pivotIndex >= 0)
+            color = QColor(186, 85, 211);
+        else if (k == index1 || k == index2)
+            color = QColor(30, 144, 255);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
+
+    if (currentAlgorithm == SortAlgorithm::Quick3) {
+        if (k == index1)
+            color = QColor(30, 144, 255);
+        else if (pivotIndex >= 0 && k >= pivotIndex && k < index1)
+            color = QColor(255, 215, 0);
+        else if (k == index2)
+            color = QColor(255, 165, 0);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
+
+    if (currentAlgorithm == SortAlgorithm::DualPivot) {
+        if (dualLeft >= 0 && (k == dualLeft || k == dualRight))
+            color = QColor(186, 85, 211);
+        else if (k == index1)
+            color = QColor(220, 20, 60);
+        else if (dualLeft >= 0 && k > dualLeft && k < pivotIndex)
+            color = QColor(135, 206, 250);
+        else if (dualLeft >= 0 && k >= pivotIndex && k < index1)
+            color = QColor(255, 215, 0);
+        else if (dualLeft >= 0 && k > index2 && k < dualRight)
+            color = QColor(255, 105, 180);
+        else if (dualLeft < 0 && k == index2)
+            color = QColor(220, 20, 60);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
 
-        if (currentAlgorithm == SortAlgorithm::Bubble) {
-            if (k == index1 || k == index2)
-                color = QColor(220, 20, 60);
-            else if (activeSorted->contains(k))
-                color = QColor(0, 255, 0);
-        }
+    if (currentAlgorithm == SortAlgorithm::Heap) {
+        if (k == index1)
+            color = QColor(255, 165, 0);
+        else if (k == index2)
+            color = QColor(255, 0, 0);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
 
-        if (currentAlgorithm == SortAlgorithm::Insertion) {
-            if (k == index1)
-                color = QColor(65, 105, 225);
-            else if (k == index2)
-                color = QColor(255, 165, 0);
-            else if (activeSorted->contains(k))
-                color = QColor(0, 255, 0);
+    if (currentAlgorithm == SortAlgorithm::Bubble) {
+        if (k == index1 || k == index2)
+            color = QColor(220, 20, 60);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
+
+    if (currentAlgorithm == SortAlgorithm::Insertion) {
+        if (k == index1)
+            color = QColor(65, 105, 225);
+        else if (k == index2)
+            color = QColor(255, 165, 0);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
+
+    if (currentAlgorithm == SortAlgorithm::Selection) {
+        if (k == index1)
+            color = QColor(128, 0, 128);
+        else if (k == index2)
+            color = QColor(255, 0, 0);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
+    if (currentAlgorithm == SortAlgorithm::Shell) {
+        if (shellInserting && k == shellI)
+            color = QColor(65, 105, 225);
+        else if (shellInserting && (k == shellJ || k == shellJ + gap))
+            color = QColor(255, 165, 0);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
+    if (currentAlgorithm == SortAlgorithm::Tim) {
+        if (timInserting && k == timI)
+            color = QColor(65, 105, 225);
+        else if ((timInserting && (k == timJ || k == timJ + 1)) ||
+            (timMerging && (k == timLeft || k == timMid)) ||
+            (timMerging && timRunWidth > 0 && (k == index1 || k == index2)))
+            color = QColor(255, 165, 0);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+        else if (timMerging && timRunWidth > 0 && k >= timLeft && k < timRight)
+            color = ((k - timLeft) / timRunWidth) % 2 == 0 ? QColor(176, 196, 222) : QColor(221, 160, 221);
+    }
+    if (currentAlgorithm == SortAlgorithm::BlockMerge) {
+        if (timInserting && k == timI)
+            color = QColor(65, 105, 225);
+        else if (timInserting && (k == timJ || k == timJ + 1))
+            color = QColor(255, 165, 0);
+        else if (k == index1 || k == index2)
+            color = QColor(220, 20, 60);
+        else if (k >= rotateFirst && k < rotateMiddle)
+            color = QColor(255, 215, 0);
+        else if (k >= rotateMiddle && k < rotateLast)
+            color = QColor(255, 140, 0);
+        else if (k >= mergeLeftStart && k <= mergeLeftEnd)
+            color = QColor(0, 255, 255);
+        else if (k >= mergeRightStart && k <= mergeRightEnd)
+            color = QColor(255, 20, 147);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
+    if (currentAlgorithm == SortAlgorithm::NaturalMerge) {
+        if (timInserting && k == timI)
+            color = QColor(65, 105, 225);
+        else if (timInserting && (k == timJ || k == timJ + 1))
+            color = QColor(255, 165, 0);
+        else if (k == index1 || k == index2)
+            color = QColor(220, 20, 60);
+        else if (k >= naturalRunStart && k < naturalRunEnd)
+            color = QColor(255, 215, 0);
+        else if (k >= mergeLeftStart && k <= mergeLeftEnd)
+            color = QColor(0, 255, 255);
+        else if (k >= mergeRightStart && k <= mergeRightEnd)
+            color = QColor(255, 20, 147);
+        else if ((k >= mergeMergedStart && k <= mergeMergedEnd) || activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
+    if (currentAlgorithm == SortAlgorithm::Bucket && timInserting) {
+        if (k == index1)
+            color = QColor(255, 165, 0);
+        else if (activeSorted->contains(k))
+            color = QColor(0, 255, 0);
+    }
+    else if (currentAlgorithm == SortAlgorithm::Radix || currentAlgorithm == SortAlgorithm::Counting ||
+             currentAlgorithm == SortAlgorithm::Bucket) {
+        if (radixPhase == RadixPhase::Count && k == radixIndex) {
+            color = QColor(65, 105, 225);
         }
-
-        if (currentAlgorithm == SortAlgorithm::Selection) {
-            if (k == index1)
-                color = QColor(128, 0, 128);
-            else if (k == index2)
-                color = QColor(255, 0, 0);
-            else if (activeSorted->contains(k))
-                color = QColor(0, 255, 0);
+        else if ((radixPhase == RadixPhase::Accumulate && k == radixIndex) ||
+            (radixPhase == RadixPhase::Place && k == radixIndex)) {
+            color = QColor(255, 165, 0);
         }
-        if (currentAlgorithm == SortAlgorithm::Shell) {
-            if (shellInserting && k == shellI)
-                color = QColor(65, 105, 225);
-            else if (shellInserting && (k == shellJ || k == shellJ + gap))
-                color = QColor(255, 165, 0);
-            else if (activeSorted->contains(k))
-                color = QColor(0, 255, 0);
+        else if (radixPhase == RadixPhase::CopyBack && k == radixIndex) {
+            color = QColor(0, 255, 0);
         }
-        if (currentAlgorithm == SortAlgorithm::Tim) {
-            if (timInserting && k == timI)
-                color = QColor(65, 105, 225);
-            else if ((timInserting && (k == timJ || k == timJ + 1)) ||
-                (timMerging && (k == timLeft || k == timMid)))
-                color = QColor(255, 165, 0);
-            else if (activeSorted->contains(k))
-                color = QColor(0, 255, 0);
+    }
+    if (currentAlgorithm == SortAlgorithm::Gnome) {
+        if (k == index1) {
+            color = QColor(255, 0, 255);
         }
-        if (currentAlgorithm == SortAlgorithm::Radix) {
-            if (radixPhase == RadixPhase::Count && k == radixIndex) {
-                color = QColor(65, 105, 225);
-            }
-            else if ((radixPhase == RadixPhase::Accumulate && k == radixIndex) ||
-                (radixPhase == RadixPhase::Place && k == radixIndex)) {
-                color = QColor(255, 165, 0);
-            }
-            else if (radixPhase == RadixPhase::CopyBack && k == radixIndex) {
-                color = QColor(0, 255, 0);
-            }
+        else if (k == index2) {
+            color = QColor(0, 255, 255);
         }
-        if (currentAlgorithm == SortAlgorithm::Gnome) {
-            if (k == index1) {
-                color = QColor(255, 0, 255);
-            }
-            else if (k == index2) {
-                color = QColor(0, 255, 255);
-            }
-            else if (activeSorted->contains(k)) {
-                color = QColor(0, 255, 0);
-            }
+        else if (activeSorted->contains(k)) {
+            color = QColor(0, 255, 0);
         }
+    }
 
-        scene->addRect(x, 200 - barHeight, 20, barHeight, QPen(Qt::black), QBrush(color));
+    if (currentAlgorithm == SortAlgorithm::Network) {
+        if (k == index1 || k == index2)
+            color = QColor(220, 20, 60);
+        else if (k < static_cast<int>(networkLayerWires.size()) && networkLayerWires[k])
+            color = QColor(255, 165, 0);
+    }
 
-        QGraphicsTextItem* text = scene->addText(QString::number(array[k]));
-        text->setPos(x, 200 + 5);
-        x += 30;
-        text->setDefaultTextColor(QColor("#DFDFDF"));
+    if (currentAlgorithm == SortAlgorithm::Bitonic) {
+        if (k == index1 || k == index2)
+            color = QColor(220, 20, 60);
+        else if (bitonicHalf > 0)
+            color = (k / bitonicHalf) % 2 == 0 ? QColor(176, 196, 222) : QColor(221, 160, 221);
     }
 
+    // the rest of a range handed to the small-range sort, where the algorithm stopped recursing
+    if (smallRangeLeft >= 0 && k >= smallRangeLeft && k < smallRangeRight && color == QColor(200, 200, 200))
+        color = QColor(0, 128, 128);
+
+    return color;
 }
 
 MainWindow::~MainWindow()
@@ -5,24 +5,27 @@
 #include <QMainWindow>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QGraphicsView>
-#include <QGraphicsScene>
 #include <QTimer>
 #include <QLabel>
 #include <QPlainTextEdit>
 #include <QSlider>
 #include <QSpinBox>
 #include <QComboBox>
-#include <QStack>
 #include <QPair>
 #include <QPushButton>
 #include <QCheckBox>
 #include <QHBoxLayout>
 #include <QWidget>
 #include <QListWidget>
-#include <stack>
 #include <vector>
 
+#include "arrayview.h"
+#include "playbackplan.h"
+#include "sortengine.h"
+#include "frameexport.h"
+#include "trace.h"
+#include "sortedindexset.h"
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
     class MainWindow;
@@ -37,7 +40,7 @@ public:
     MainWindow(QWidget* parent = nullptr);
     ~MainWindow();
 
-    enum class SortAlgorithm { Bubble, Insertion, Selection, Quick, Merge, Heap, Shell, Tim, Radix, Gnome };
+    using SortAlgorithm = ::SortAlgorithm;
     SortAlgorithm currentAlgorithm;
 private slots:
     void onStartClicked();
@@ -48,75 +51,87 @@ private slots:
     void onRandomClicked();
     void onAlgorithmSelected(const QString& selected);
     void onControlsChanged();
+    void onPlaybackTick();
+    void onRaceClicked();
+    void onSaveTraceClicked();
+    void onLoadTraceClicked();
+    void onExportFramesClicked();
+    void onTuneCutoffClicked();
 
 private:
 
 
 
 
-    //Sorting state
-    int i = 0, j = 0, key = 0, minIndex = 0;
+    // The current run: recorded by the engine when Start is pressed, replayed one tick at a time
+    std::vector<SortEngine::SortStep> runSteps;
+    size_t runPos = 0;
+    bool presentStep(const SortEngine::SortStep& s);
+    int pseudocodeLine(const SortEngine::SortStep& s) const;
+    void showStep(int index1, int index2, int pivot);
+    void highlightFrame(int index1, int index2, int pivot);
+    void resetDisplayState();
+    void finishRun();
 
-    int quickLeft = 0, quickRight = 0;
-    QStack<QPair<int, int>> quickStack;
+    // Display state derived from the replayed steps; barColor() and the frame history read it
     int quickPivot = -1;
     int quickI = -1, quickJ = -1;
-    bool inserting = false;
-    int pivotValue = -1;
+    int quickRight = -1;
+    int quickPivotValue = 0;   // 3-way quick sort classifies its swaps by it
+    bool quickPartitioning = false; // false while a pivot is being chosen and moved into place
+    // Dual-pivot quick sort: the pivots at the ends of the range being partitioned (-1 between
+    // partitions); quickPivot, quickI and quickJ then hold lt, k and gt
+    int dualLeft = -1, dualRight = -1;
+    bool dualGathering = false;     // the pass moving keys equal to the pivots next to them
+    int smallRangeLeft = -1, smallRangeRight = -1; // range below the cutoff being finished, [left, right)
+    std::vector<SortEngine::NetworkComparator> networkComparators; // Sorting Network: ordered by layer
+    std::vector<char> networkLayerWires; // elements touched by the current comparator layer
+    int bitonicHalf = 0;           // current bitonic stage pairs element t of a span with t + bitonicHalf (or its mirror)
+    bool bitonicMirrored = false;
 
     int mergeLeftStart = -1, mergeLeftEnd = -1;
     int mergeRightStart = -1, mergeRightEnd = -1;
     int mergeMergedStart = -1, mergeMergedEnd = -1;
 
-    // QStack<QPair<int, int>> mergeStack;
-    std::vector<int> mergeBuffer;
-    std::stack<std::tuple<int, int, bool>> mergeStack; // bool = isMergePhase
+    bool heapBuilding = false;
 
-    int mergeLeft = -1, mergeMid = -1, mergeRight = -1;
-    int mergeI = -1, mergeJ = -1, mergeK = -1;
-    bool merging = false;
+    int gap = 0;
+    int shellI = -1;
+    int shellJ = -1;
+    bool shellInserting = false;
 
-    int heapSize = 0;
-    bool heapBuilding = false;
-    bool heapSwapping = false;
-    std::stack<int> heapStack;
-    int heapI = -1;
-    int heapJ = -1;
-
-    int gap;
-    int shellI;
-    int shellJ;
-    int shellKey;
-    bool shellInserting;
-
-
-    int timRunSize;
-    std::vector<std::pair<int, int>> timRuns;
-    int timStart, timEnd;
-    int timI, timJ, timKey;
-    bool timInserting;
-    bool timMerging;
-    int timLeft, timMid, timRight;
-    std::vector<int> timMergeBuffer;
-
-    bool radixInitialized = false;
-    int maxValue;
-    int digitPlace;
-    int radixIndex;
-    std::vector<int> count = std::vector<int>(10, 0);
-    std::vector<int> bucket;
-    enum class RadixPhase { Count, Accumulate, Place, CopyBack };
-    RadixPhase radixPhase;
+    int timI = -1, timJ = -1;
+    bool timInserting = false;
+    bool timMerging = false;
+    int timLeft = -1, timMid = -1, timRight = -1;
+    int timRunWidth = 0;           // runs of this many elements tile [timLeft, timRight) in a k-way merge
 
-    int gnomeIndex;
+    int rotateFirst = -1, rotateMiddle = -1, rotateLast = -1; // block merge: [first, middle) and [middle, last) trade places
+    int naturalRunStart = -1, naturalRunEnd = -1; // natural merge: the run just found in the input
+    int naturalRunsLeft = 0;                      // runs left at the current merge pass; 0 while scanning for runs
+
+    int radixIndex = -1;
+    enum class RadixPhase { Count, Accumulate, Place, CopyBack };
+    RadixPhase radixPhase = RadixPhase::Count;
 
     inline void pushFrame(const std::vector<int>& arr, int i, int j, int pivot = -1) {
+        // how much this frame changes the picture; budgeted playback keeps the largest changes
+        int changed = sortedIndicesHistory.pendingCount();
+        if (!history.empty() && history.back().size() == arr.size()) {
+            const std::vector<int>& prev = history.back();
+            for (size_t k = 0; k < arr.size(); ++k) changed += (prev[k] != arr[k]);
+        }
+        else {
+            changed += static_cast<int>(arr.size());
+        }
+        frameChangeHistory.push_back(changed);
+
         history.push_back(arr);
         iHistory.push_back(i);
         jHistory.push_back(j);
         pivotHistory.push_back(pivot);
-        // record which indices are currently considered sorted (snapshot)
-        sortedIndicesHistory.push_back(sortedIndices);
+        // record which indices are currently considered sorted (only the change since the last frame)
+        sortedIndicesHistory.markFrame();
         // record radix-specific state for this frame
         radixPhaseHistory.push_back(radixPhase);
         radixIndexHistory.push_back(radixIndex);
@@ -132,7 +147,23 @@ private:
         timLeftHistory.push_back(timLeft);
         timMidHistory.push_back(timMid);
         timRightHistory.push_back(timRight);
-        {
+        // record merge ranges
+        mergeLeftStartHistory.push_back(mergeLeftStart);
+        mergeLeftEndHistory.push_back(mergeLeftEnd);
+        mergeRightStartHistory.push_back(mergeRightStart);
+        mergeRightEndHistory.push_back(mergeRightEnd);
+        mergeMergedStartHistory.push_back(mergeMergedStart);
+        mergeMergedEndHistory.push_back(mergeMergedEnd);
+        dualLeftHistory.push_back(dualLeft);
+        dualRightHistory.push_back(dualRight);
+        timRunWidthHistory.push_back(timRunWidth);
+        rotateFirstHistory.push_back(rotateFirst);
+        rotateMiddleHistory.push_back(rotateMiddle);
+        rotateLastHistory.push_back(rotateLast);
+        naturalRunStartHistory.push_back(naturalRunStart);
+        naturalRunEndHistory.push_back(naturalRunEnd);
+        naturalRunsLeftHistory.push_back(naturalRunsLeft);
+        if (!recordingOnly) {
             QSignalBlocker block(slider);
             int step = static_cast<int>(history.size()) - 1;
             slider->setMaximum(step);
@@ -141,19 +172,48 @@ private:
     }
 
 
+    inline void markSorted(int index) {
+        if (sortedIndices.insert(index)) sortedIndicesHistory.record(index);
+    }
+    inline void markSortedRange(int first, int last) {
+        for (int k = first; k < last; ++k) markSorted(k);
+    }
+
     bool stepMode = false;
 
+    // Time-budgeted playback: the run is recorded without drawing, then a planned subset of
+    // its frames is replayed so the animation takes a fixed wall-clock time.
+    bool recordingOnly = false;
+    QTimer* playbackTimer;
+    PlaybackPlan playbackPlan;
+    int playbackPos = 0;
+    std::vector<int> frameChangeHistory;
+    bool playbackActive() const { return playbackPos < static_cast<int>(playbackPlan.frames.size()); }
+    void stopPlayback();
+    void recordAndPlay(int durationMs);
+
     Ui::MainWindow* ui;
     QLineEdit* inputField;
     QPushButton* startButton;
-    QGraphicsView* view;
-    QGraphicsScene* scene;
+    ArrayView* view;
     QTimer* timer;
     QLabel* stepLabel;
     QPlainTextEdit* logView;
     QLabel* descriptionLabel;
     QSlider* delayBox;
+    QSpinBox* durationSpinBox;
     QComboBox* algorithmBox;
+    QComboBox* pivotBox;
+    QLabel* pivotLabel;
+    QComboBox* heapBox;
+    QLabel* heapLabel;
+    QComboBox* gapBox;
+    QLabel* gapLabel;
+    QSpinBox* cutoffSpinBox;
+    QComboBox* smallSortBox;
+    QLabel* cutoffLabel;
+    QPushButton* tuneCutoffButton;
+    SortOptions currentSortOptions() const; // pivot, heap, gaps and cutoff as set in the toolbar
     QLabel* legendLabel;
     QPushButton* resetButton;
     QCheckBox* stepByStepCheck;
@@ -167,14 +227,20 @@ private:
     QLabel* stepCounterLabel;
     QLabel* stepDescriptionLabel;
     QPushButton* randomButton;
+    QPushButton* raceButton;
+    QPushButton* saveTraceButton;
+    QPushButton* loadTraceButton;
+    QPushButton* exportFramesButton;
     QSpinBox* sizeSpinBox;
+    QSpinBox* seedSpinBox;
     QComboBox* distributionBox;
     QSlider* nearlySortedSlider;
     QLabel* nearlySortedValueLabel;
     QLabel* bigoDescriptionLabel;
+    QLabel* metricsLabel;
+    void updateMetrics(const std::vector<int>& input); // exact presortedness of the input
     // QCheckBox* darkModeToggle;
     void generateArrayFromControls(bool log = true);
-    QGraphicsTextItem* complexityLabel = nullptr;
     QLabel* legendTitleLabel;
     bool darkModeEnabled = false;
 
@@ -185,11 +251,12 @@ private:
     void highlightPseudocodeLine(int index); // index is 0-based
 
     std::vector<int> array;
+    std::vector<int> runInput; // array as it was when the current run started
     std::vector<std::vector<int>> history;
     std::vector<int> pivotHistory;
     std::vector<int> iHistory;
     std::vector<int> jHistory;
-    std::vector<QSet<int>> sortedIndicesHistory;
+    SortedIndexHistory sortedIndicesHistory;
     std::vector<RadixPhase> radixPhaseHistory;
     std::vector<int> radixIndexHistory;
     // Shell sort per-frame state
@@ -204,22 +271,45 @@ private:
     std::vector<int> timLeftHistory;
     std::vector<int> timMidHistory;
     std::vector<int> timRightHistory;
-    QSet<int> sortedIndices;
-    QSet<int> displayedSortedIndices; // used when scrubbing history to show per-frame sorted state
+    SortedIndexSet sortedIndices;
+    SortedIndexSet displayedSortedIndices; // used when scrubbing history to show per-frame sorted state
     std::vector<int> mergeLeftStartHistory;
     std::vector<int> mergeLeftEndHistory;
     std::vector<int> mergeRightStartHistory;
     std::vector<int> mergeRightEndHistory;
     std::vector<int> mergeMergedStartHistory;
     std::vector<int> mergeMergedEndHistory;
+    std::vector<int> dualLeftHistory;
+    std::vector<int> dualRightHistory;
+    std::vector<int> timRunWidthHistory;
+    std::vector<int> rotateFirstHistory;
+    std::vector<int> rotateMiddleHistory;
+    std::vector<int> rotateLastHistory;
+    std::vector<int> naturalRunStartHistory;
+    std::vector<int> naturalRunEndHistory;
+    std::vector<int> naturalRunsLeftHistory;
 
 
     int currentStep = 0;
     int stepDelay;
 
+    // Replay of a saved run; while open, the slider seeks into it instead of 'history'
+    TraceReader loadedTrace;
+    QString loadedTracePath;
+    bool writeTrace(const QString& path, QString& error);
+    void clearHistory();
+    std::vector<int> frameExtras(int frame) const;
+    void applyFrameExtras(const std::vector<int>& extras);
+
+    // What the array view paints: plain bars, the last highlightComparison() call, or all sorted
+    enum class BarMode { Plain, Highlight, Finished };
+    BarMode barMode = BarMode::Plain;
+    int highlightIndex1 = -1, highlightIndex2 = -1, highlightPivot = -1;
+
     void drawArray(const std::vector<int>& arr);
     void highlightComparison(int index1, int index2, int pivotIndex); //If the algorithm doesn't contain any pivot just pass -1 as the third argument so it doesn't throw errors
     void drawArrayFinished(const std::vector<int>& arr);
+    QColor barColor(int k) const;
     void setStep(const QString& msg);
     void appendLog(const QString& msg);
     void updateScene();
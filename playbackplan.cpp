@@ -0,0 +1,37 @@
+#include "playbackplan.h"
+
+#include <algorithm>
+
+PlaybackPlan planPlayback(const std::vector<int>& frameChanges, int durationMs, int minIntervalMs) {
+    PlaybackPlan plan;
+    const long long frames = static_cast<long long>(frameChanges.size());
+    if (frames == 0 || durationMs <= 0) return plan;
+
+    minIntervalMs = std::max(1, minIntervalMs);
+    const long long slots = std::max(1, durationMs / minIntervalMs);
+
+    if (frames <= slots) {
+        // everything fits: show every frame, stretched to the duration
+        plan.frames.resize(frames);
+        for (long long f = 0; f < frames; ++f) plan.frames[f] = static_cast<int>(f);
+        plan.intervalMs = std::max<int>(minIntervalMs, static_cast<int>(durationMs / frames));
+        return plan;
+    }
+
+    plan.frames.reserve(slots);
+    for (long long s = 0; s < slots; ++s) {
+        long long begin = s * frames / slots;
+        long long end = (s + 1) * frames / slots;
+
+        // largest change in the window; ties go to the later frame so progress looks steady
+        long long best = begin;
+        for (long long f = begin; f < end; ++f) {
+            if (frameChanges[f] >= frameChanges[best]) best = f;
+        }
+        plan.frames.push_back(static_cast<int>(best));
+    }
+    // always land on the final state
+    plan.frames.back() = static_cast<int>(frames - 1);
+    plan.intervalMs = static_cast<int>(durationMs / slots);
+    return plan;
+}
@@ -0,0 +1,19 @@
+#ifndef PLAYBACKPLAN_H
+#define PLAYBACKPLAN_H
+
+#include <vector>
+
+// Which recorded frames to show, and how fast, so that a whole run plays back in a fixed
+// wall-clock duration regardless of how many steps the algorithm took.
+struct PlaybackPlan {
+    std::vector<int> frames; // history indices to display, ascending, always ending at the last frame
+    int intervalMs = 0;      // timer interval between displayed frames
+};
+
+// frameChanges[f] is how much the state changed in frame f (elements moved, indices settled).
+// If there are more frames than the duration allows at minIntervalMs per frame, the frames are
+// split into equal consecutive windows and each window is represented by its largest change;
+// the skipped frames are coalesced into it, since every frame is a full snapshot.
+PlaybackPlan planPlayback(const std::vector<int>& frameChanges, int durationMs, int minIntervalMs = 16);
+
+#endif // PLAYBACKPLAN_H
@@ -0,0 +1,239 @@
+#include "racewindow.h"
+
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QFont>
+#include <algorithm>
+#include <chrono>
+
+void RaceProbe::step(const std::vector<int>& a, int, int) {
+    steps.fetch_add(1, std::memory_order_relaxed);
+    if (cancelled.load(std::memory_order_relaxed)) throw RaceCancelled();
+
+    // copy the array only when the GUI is about to paint, not on every step
+    if (snapshotWanted.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = a;
+        fresh = true;
+        snapshotWanted.store(false, std::memory_order_relaxed);
+    }
+
+    if (stepDelayUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(stepDelayUs));
+}
+
+bool RaceProbe::takeSnapshot(std::vector<int>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!fresh) return false;
+    out.swap(snapshot);
+    fresh = false;
+    return true;
+}
+
+RaceWindow::RaceWindow(const std::vector<int>& in, QWidget* parent)
+    : QDialog(parent), input(in)
+{
+    setWindowTitle("Race Mode");
+    resize(1300, 850);
+
+    algorithmList = new QListWidget();
+    for (SortAlgorithm alg : allAlgorithms()) {
+        QListWidgetItem* it = new QListWidgetItem(algorithmName(alg));
+        it->setFlags(it->flags() | Qt::ItemIsUserCheckable);
+        bool preselect = (alg == SortAlgorithm::Quick || alg == SortAlgorithm::Merge || alg == SortAlgorithm::Insertion);
+        it->setCheckState(preselect ? Qt::Checked : Qt::Unchecked);
+        it->setData(Qt::UserRole, static_cast<int>(alg));
+        algorithmList->addItem(it);
+    }
+    algorithmList->setFixedWidth(200);
+
+    delaySpinBox = new QSpinBox();
+    delaySpinBox->setRange(0, 100000);
+    delaySpinBox->setValue(input.size() <= 200 ? 2000 : 0);
+    delaySpinBox->setSuffix(" µs");
+    delaySpinBox->setToolTip("Pause after every array write so small races stay watchable (0 = full speed)");
+
+    startButton = new QPushButton("Start Race");
+    statusLabel = new QLabel(QString("Input: %1 elements").arg(input.size()));
+
+    resultTable = new QTableWidget(0, 5);
+    resultTable->setHorizontalHeaderLabels({ "Rank", "Algorithm", "Time (ms)", "Steps", "Comparisons" });
+    resultTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    resultTable->verticalHeader()->setVisible(false);
+    resultTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    resultTable->setFixedHeight(220);
+
+    QVBoxLayout* controls = new QVBoxLayout();
+    controls->addWidget(new QLabel("Algorithms:"));
+    controls->addWidget(algorithmList, 1);
+    controls->addWidget(new QLabel("Delay per step:"));
+    controls->addWidget(delaySpinBox);
+    controls->addWidget(startButton);
+
+    panelGrid = new QGridLayout();
+    panelGrid->setSpacing(8);
+
+    QVBoxLayout* raceColumn = new QVBoxLayout();
+    raceColumn->addWidget(statusLabel);
+    raceColumn->addLayout(panelGrid, 1);
+    raceColumn->addWidget(new QLabel("Results"));
+    raceColumn->addWidget(resultTable);
+
+    QHBoxLayout* mainLayout = new QHBoxLayout(this);
+    mainLayout->addLayout(controls);
+    mainLayout->addLayout(raceColumn, 1);
+
+    refreshTimer = new QTimer(this);
+    connect(refreshTimer, &QTimer::timeout, this, &RaceWindow::onRefresh);
+    connect(startButton, &QPushButton::clicked, this, &RaceWindow::onStartRace);
+}
+
+RaceWindow::~RaceWindow() {
+    stopRace();
+}
+
+void RaceWindow::stopRace() {
+    refreshTimer->stop();
+    for (auto& lane : lanes) {
+        if (!lane->done.load()) lane->probe.cancelled.store(true);
+    }
+    go.store(true, std::memory_order_release); // release workers still waiting for the start
+    for (auto& lane : lanes) {
+        if (lane->worker.joinable()) lane->worker.join();
+    }
+}
+
+void RaceWindow::onStartRace() {
+    stopRace();
+
+    for (auto& lane : lanes) delete lane->panel;
+    lanes.clear();
+    resultTable->setRowCount(0);
+
+    for (int r = 0; r < algorithmList->count(); ++r) {
+        QListWidgetItem* it = algorithmList->item(r);
+        if (it->checkState() != Qt::Checked) continue;
+
+        auto lane = std::make_unique<Lane>();
+        lane->algorithm = static_cast<SortAlgorithm>(it->data(Qt::UserRole).toInt());
+        lane->data = input;
+        lane->shown = input;
+        lane->probe.stepDelayUs = delaySpinBox->value();
+
+        lane->panel = new QWidget();
+        QVBoxLayout* panelLayout = new QVBoxLayout(lane->panel);
+        panelLayout->setContentsMargins(0, 0, 0, 0);
+        QLabel* title = new QLabel(algorithmName(lane->algorithm));
+        QFont f = title->font();
+        f.setBold(true);
+        title->setFont(f);
+        lane->view = new ArrayView();
+        lane->view->setNeutralColor(QColor(65, 105, 225));
+        lane->view->setValues(&lane->shown);
+        lane->statsLabel = new QLabel();
+        panelLayout->addWidget(title);
+        panelLayout->addWidget(lane->view, 1);
+        panelLayout->addWidget(lane->statsLabel);
+
+        int index = static_cast<int>(lanes.size());
+        panelGrid->addWidget(lane->panel, index / 2, index % 2);
+        lanes.push_back(std::move(lane));
+    }
+
+    if (lanes.empty()) {
+        statusLabel->setText("Select at least one algorithm.");
+        return;
+    }
+
+    // all workers wait on 'go' so they start together
+    go.store(false);
+    for (auto& owned : lanes) {
+        Lane* lane = owned.get();
+        lane->worker = std::thread([this, lane] {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+            try {
+                SortEngine::run(lane->algorithm, lane->data, lane->probe);
+            }
+            catch (const RaceCancelled&) {
+            }
+
+            // the ranking times the untraced instantiation, like the main window and --stats do
+            if (!lane->probe.cancelled.load()) {
+                std::vector<int> timed = input;
+                SortEngine::NullTracer untraced;
+                auto start = std::chrono::steady_clock::now();
+                SortEngine::run(lane->algorithm, timed, untraced);
+                lane->sortNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+            lane->done.store(true, std::memory_order_release);
+        });
+    }
+
+    statusLabel->setText(QString("Racing %1 algorithms on %2 elements...").arg(lanes.size()).arg(input.size()));
+    startButton->setEnabled(false);
+    clock.start();
+    go.store(true, std::memory_order_release);
+    refreshTimer->start(33);
+    onRefresh();
+}
+
+void RaceWindow::onRefresh() {
+    // every panel is refreshed on the same tick so they stay comparable
+    bool allDone = true;
+    for (auto& owned : lanes) {
+        Lane* lane = owned.get();
+        bool done = lane->done.load(std::memory_order_acquire);
+
+        if (done && !lane->finishedShown) {
+            // the worker no longer touches 'data'
+            lane->shown = lane->data;
+            lane->finishedShown = true;
+            lane->view->setNeutralColor(QColor(0, 255, 0));
+        }
+        else if (!done) {
+            lane->probe.takeSnapshot(lane->shown);
+            lane->probe.snapshotWanted.store(true, std::memory_order_relaxed);
+            allDone = false;
+        }
+        lane->view->update();
+
+        double ms = done ? lane->sortNs.load() / 1e6 : static_cast<double>(clock.elapsed());
+        lane->statsLabel->setText(QString("Steps: %1 | Comparisons: %2 | Time: %3 ms%4")
+                                      .arg(lane->probe.steps.load())
+                                      .arg(lane->probe.comparisons.load())
+                                      .arg(ms, 0, 'f', 2)
+                                      .arg(done ? "  (finished)" : ""));
+    }
+
+    if (allDone) {
+        refreshTimer->stop();
+        stopRace();
+        showResults();
+        startButton->setEnabled(true);
+    }
+}
+
+void RaceWindow::showResults() {
+    std::vector<Lane*> ranked;
+    for (auto& lane : lanes) {
+        if (!lane->probe.cancelled.load()) ranked.push_back(lane.get());
+    }
+    std::sort(ranked.begin(), ranked.end(), [](Lane* a, Lane* b) {
+        return a->sortNs.load() < b->sortNs.load();
+    });
+
+    resultTable->setRowCount(static_cast<int>(ranked.size()));
+    for (int r = 0; r < static_cast<int>(ranked.size()); ++r) {
+        Lane* lane = ranked[r];
+        resultTable->setItem(r, 0, new QTableWidgetItem(QString::number(r + 1)));
+        resultTable->setItem(r, 1, new QTableWidgetItem(algorithmName(lane->algorithm)));
+        resultTable->setItem(r, 2, new QTableWidgetItem(QString::number(lane->sortNs.load() / 1e6, 'f', 3)));
+        resultTable->setItem(r, 3, new QTableWidgetItem(QString::number(lane->probe.steps.load())));
+        resultTable->setItem(r, 4, new QTableWidgetItem(QString::number(lane->probe.comparisons.load())));
+    }
+
+    if (!ranked.empty())
+        statusLabel->setText(QString("Finished. Winner: %1").arg(algorithmName(ranked.front()->algorithm)));
+}
@@ -0,0 +1,96 @@
+#ifndef RACEWINDOW_H
+#define RACEWINDOW_H
+
+#include <QDialog>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QListWidget>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QTimer>
+#include <QGridLayout>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "arrayview.h"
+#include "sortengine.h"
+
+struct RaceCancelled {};
+
+// Probe used by race workers: counts work, hands out array snapshots when the GUI asks
+// for one, and aborts the sort (by throwing RaceCancelled) when the race is stopped.
+class RaceProbe : public SortEngine::NullTracer
+{
+public:
+    // every lane animates and counts, so the sorts must take their traced paths
+    static constexpr bool records = true;
+
+    std::atomic<long long> steps{0};
+    std::atomic<long long> comparisons{0};
+    std::atomic<bool> snapshotWanted{true};
+    std::atomic<bool> cancelled{false};
+    int stepDelayUs = 0;
+
+    void compare(int, int) { comparisons.fetch_add(1, std::memory_order_relaxed); }
+    void step(const std::vector<int>& a, int, int = -1);
+
+    // GUI side: copies the latest snapshot into 'out' if a new one arrived.
+    bool takeSnapshot(std::vector<int>& out);
+
+private:
+    std::mutex mutex;
+    std::vector<int> snapshot;
+    bool fresh = false;
+};
+
+// Runs several algorithms at once on copies of the same input, one worker thread each,
+// with one panel per algorithm refreshed together and a ranking when all have finished.
+class RaceWindow : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit RaceWindow(const std::vector<int>& input, QWidget* parent = nullptr);
+    ~RaceWindow();
+
+private slots:
+    void onStartRace();
+    void onRefresh();
+
+private:
+    struct Lane {
+        SortAlgorithm algorithm;
+        std::vector<int> data;   // owned by the worker until 'done'
+        std::vector<int> shown;  // GUI copy painted by the view
+        RaceProbe probe;
+        std::thread worker;
+        std::atomic<bool> done{false};
+        std::atomic<long long> sortNs{0}; // untraced run of the same input, without delays or snapshots
+        bool finishedShown = false;
+        QWidget* panel = nullptr;
+        ArrayView* view = nullptr;
+        QLabel* statsLabel = nullptr;
+    };
+
+    void stopRace();
+    void showResults();
+
+    std::vector<int> input;
+    std::vector<std::unique_ptr<Lane>> lanes;
+    std::atomic<bool> go{false};
+    QElapsedTimer clock;
+
+    QListWidget* algorithmList;
+    QSpinBox* delaySpinBox;
+    QPushButton* startButton;
+    QGridLayout* panelGrid;
+    QTableWidget* resultTable;
+    QLabel* statusLabel;
+    QTimer* refreshTimer;
+};
+
+#endif // RACEWINDOW_H
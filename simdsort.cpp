@@ -0,0 +1,270 @@
+#include "simdsort.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "sortnetwork.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMDSORT_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile the vector kernel for AVX2 without raising the baseline of the whole
+// build; MSVC accepts the intrinsics anywhere.
+#if defined(SIMDSORT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMDSORT_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMDSORT_AVX2
+#endif
+
+namespace SortEngine {
+
+namespace {
+
+// Below this the unrolled scalar network is already cheaper than filling eight registers.
+const int kVectorFrom = 24;
+
+inline void minMax(int& a, int& b) {
+    const int x = a, y = b;
+    a = y < x ? y : x;
+    b = y < x ? x : y;
+}
+
+void scalarSortSmall(int* p, int n) {
+    if (n <= kMaxFixedNetwork) {
+        networkKernels[n](p);
+        return;
+    }
+    for (int i = 1; i < n; ++i) {
+        int key = p[i];
+        int j = i;
+        for (; j > 0 && p[j - 1] > key; --j) p[j] = p[j - 1];
+        p[j] = key;
+    }
+}
+
+#ifdef SIMDSORT_X86
+
+SIMDSORT_AVX2 inline void compareExchange(__m256i& a, __m256i& b) {
+    const __m256i lo = _mm256_min_epi32(a, b);
+    b = _mm256_max_epi32(a, b);
+    a = lo;
+}
+
+// Sorts the eight lanes of a bitonic register: half cleaners at lane distance 4, 2 and 1.
+SIMDSORT_AVX2 inline __m256i mergeLanes(__m256i v) {
+    __m256i p = _mm256_permute2x128_si256(v, v, 0x01);
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xF0);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xCC);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xAA);
+}
+
+SIMDSORT_AVX2 inline __m256i reverseLanes(__m256i v) {
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+// v[0, 2K) holds two sorted runs of K registers (element e is lane e % 8 of register e / 8).
+// Reversing the second run makes the whole bitonic; half cleaners between registers, then
+// within them, sort it.
+template <int K>
+SIMDSORT_AVX2 inline void bitonicMerge(__m256i* v) {
+    for (int i = 0; i < K / 2; ++i) std::swap(v[K + i], v[2 * K - 1 - i]);
+    for (int i = K; i < 2 * K; ++i) v[i] = reverseLanes(v[i]);
+    for (int d = K; d > 0; d /= 2) {
+        for (int i = 0; i < 2 * K; ++i) {
+            if ((i & d) == 0) compareExchange(v[i], v[i + d]);
+        }
+    }
+    for (int i = 0; i < 2 * K; ++i) v[i] = mergeLanes(v[i]);
+}
+
+SIMDSORT_AVX2 inline void transpose8x8(__m256i* v) {
+    __m256i t[8], s[8];
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_epi32(v[i], v[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(v[i], v[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        s[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        s[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        s[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        s[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        v[i] = _mm256_permute2x128_si256(s[i], s[i + 4], 0x20);
+        v[i + 4] = _mm256_permute2x128_si256(s[i], s[i + 4], 0x31);
+    }
+}
+
+// Sorts up to 32 ints in four registers: the 4-input network sorts every lane column, two unpack
+// rounds gather columns c and c + 4 into one register, and merges join the halves, then the rows.
+SIMDSORT_AVX2 void avx2Sort32(int* p, int n) {
+    alignas(32) int buffer[32];
+    std::copy(p, p + n, buffer);
+    std::fill(buffer + n, buffer + 32, INT_MAX);
+
+    __m256i v[4];
+    for (int i = 0; i < 4; ++i) v[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(buffer) + i);
+    for (const NetworkComparator& c : FixedNetwork<4>::network.comparators) compareExchange(v[c.a], v[c.b]);
+    const __m256i t0 = _mm256_unpacklo_epi32(v[0], v[1]), t1 = _mm256_unpackhi_epi32(v[0], v[1]);
+    const __m256i t2 = _mm256_unpacklo_epi32(v[2], v[3]), t3 = _mm256_unpackhi_epi32(v[2], v[3]);
+    v[0] = _mm256_unpacklo_epi64(t0, t2);
+    v[1] = _mm256_unpackhi_epi64(t0, t2);
+    v[2] = _mm256_unpacklo_epi64(t1, t3);
+    v[3] = _mm256_unpackhi_epi64(t1, t3);
+    // two sorted runs of four per register: reversing the upper one makes the register bitonic
+    const __m256i reverseUpper = _mm256_setr_epi32(0, 1, 2, 3, 7, 6, 5, 4);
+    for (int i = 0; i < 4; ++i) v[i] = mergeLanes(_mm256_permutevar8x32_epi32(v[i], reverseUpper));
+    bitonicMerge<1>(v);
+    bitonicMerge<1>(v + 2);
+    bitonicMerge<2>(v);
+
+    for (int i = 0; i < 4; ++i) _mm256_store_si256(reinterpret_cast<__m256i*>(buffer) + i, v[i]);
+    std::copy(buffer, buffer + n, p);
+}
+
+// Sorts up to 64 ints: the 8-input network over whole registers sorts every lane column, the
+// transpose turns the columns into eight sorted rows, and three rounds of merges join them.
+SIMDSORT_AVX2 void avx2Sort64(int* p, int n) {
+    alignas(32) int buffer[kSimdBlock];
+    std::copy(p, p + n, buffer);
+    std::fill(buffer + n, buffer + kSimdBlock, INT_MAX);
+
+    __m256i v[8];
+    for (int i = 0; i < 8; ++i) v[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(buffer) + i);
+    for (const NetworkComparator& c : FixedNetwork<8>::network.comparators) compareExchange(v[c.a], v[c.b]);
+    transpose8x8(v);
+    for (int i = 0; i < 8; i += 2) bitonicMerge<1>(v + i);
+    for (int i = 0; i < 8; i += 4) bitonicMerge<2>(v + i);
+    bitonicMerge<4>(v);
+
+    for (int i = 0; i < 8; ++i) _mm256_store_si256(reinterpret_cast<__m256i*>(buffer) + i, v[i]);
+    std::copy(buffer, buffer + n, p);
+}
+
+SIMDSORT_AVX2 void avx2MinMax(int* lo, int* hi, int count) {
+    int t = 0;
+    for (; t + 8 <= count; t += 8) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo + t));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi + t));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo + t), _mm256_min_epi32(x, y));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hi + t), _mm256_max_epi32(x, y));
+    }
+    for (; t < count; ++t) minMax(lo[t], hi[t]);
+}
+
+SIMDSORT_AVX2 void avx2MinMaxMirrored(int* lo, int* hiLast, int count) {
+    int t = 0;
+    for (; t + 8 <= count; t += 8) {
+        // hiLast[-t - 7 .. -t], reversed so that lane l pairs lo[t + l] with hiLast[-t - l]
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo + t));
+        const __m256i y = reverseLanes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hiLast - t - 7)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo + t), _mm256_min_epi32(x, y));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hiLast - t - 7), reverseLanes(_mm256_max_epi32(x, y)));
+    }
+    for (; t < count; ++t) minMax(lo[t], hiLast[-t]);
+}
+
+// Half cleaners at register distance 4, 2 and 1, then within the registers.
+SIMDSORT_AVX2 void avx2BitonicFinish(int* p) {
+    __m256i v[8];
+    for (int i = 0; i < 8; ++i) v[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p) + i);
+    for (int d = 4; d > 0; d /= 2) {
+        for (int i = 0; i < 8; ++i) {
+            if ((i & d) == 0) compareExchange(v[i], v[i + d]);
+        }
+    }
+    for (int i = 0; i < 8; ++i) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p) + i, mergeLanes(v[i]));
+}
+
+bool detectAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    // the CPU must have AVX2 and the OS must save the YMM registers on context switches
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+#else
+
+bool detectAvx2() {
+    return false;
+}
+
+#endif // SIMDSORT_X86
+
+const bool hasAvx2 = detectAvx2();
+
+} // namespace
+
+void simdSortSmall(int* p, int n) {
+#ifdef SIMDSORT_X86
+    if (hasAvx2 && n >= kVectorFrom) {
+        if (n <= 32) avx2Sort32(p, n);
+        else avx2Sort64(p, n);
+        return;
+    }
+#endif
+    scalarSortSmall(p, n);
+}
+
+void simdMinMax(int* lo, int* hi, int count) {
+#ifdef SIMDSORT_X86
+    if (hasAvx2) {
+        avx2MinMax(lo, hi, count);
+        return;
+    }
+#endif
+    for (int t = 0; t < count; ++t) minMax(lo[t], hi[t]);
+}
+
+void simdMinMaxMirrored(int* lo, int* hiLast, int count) {
+#ifdef SIMDSORT_X86
+    if (hasAvx2) {
+        avx2MinMaxMirrored(lo, hiLast, count);
+        return;
+    }
+#endif
+    for (int t = 0; t < count; ++t) minMax(lo[t], hiLast[-t]);
+}
+
+void simdBitonicFinish(int* p) {
+#ifdef SIMDSORT_X86
+    if (hasAvx2) {
+        avx2BitonicFinish(p);
+        return;
+    }
+#endif
+    for (int d = kSimdBlock / 2; d > 0; d /= 2) {
+        for (int i = 0; i < kSimdBlock; ++i) {
+            if ((i & d) == 0) minMax(p[i], p[i + d]);
+        }
+    }
+}
+
+bool simdSortVectorized() {
+    return hasAvx2;
+}
+
+const char* simdSortIsa() {
+    return hasAvx2 ? "AVX2" : "scalar";
+}
+
+} // namespace SortEngine
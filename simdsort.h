@@ -0,0 +1,33 @@
+#ifndef SIMDSORT_H
+#define SIMDSORT_H
+
+/*
+ * Vectorized base case for the recursive sorts: up to kSimdBlock ints are loaded into eight AVX2
+ * registers (padded with INT_MAX), sorted column-wise by a sorting network over whole registers,
+ * transposed, and combined by bitonic merges done with lane shuffles, min and max. No step of it
+ * branches on the data.
+ *
+ * The AVX2 path is chosen at run time from the CPU's feature flags; other CPUs, and builds for
+ * other architectures, get the scalar networks of sortnetwork.h and insertion sort beyond them.
+ */
+
+namespace SortEngine {
+
+constexpr int kSimdBlock = 64;
+
+// Sorts p[0, n) for n <= kSimdBlock.
+void simdSortSmall(int* p, int n);
+
+// Bitonic building blocks, vectorized the same way (used by the parallel bitonic sort):
+void simdMinMax(int* lo, int* hi, int count);             // lo[t], hi[t] = min, max of the pair
+void simdMinMaxMirrored(int* lo, int* hiLast, int count); // the same for lo[t] and hiLast[-t]
+void simdBitonicFinish(int* p);                           // sorts a bitonic block of kSimdBlock
+
+// True when simdSortSmall uses the vector kernel on this CPU.
+bool simdSortVectorized();
+// "AVX2" or "scalar", for logs.
+const char* simdSortIsa();
+
+} // namespace SortEngine
+
+#endif // SIMDSORT_H
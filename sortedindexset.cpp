@@ -0,0 +1,52 @@
+#include "sortedindexset.h"
+
+#include <algorithm>
+
+bool SortedIndexSet::insert(int index) {
+    if (index < 0) return false;
+
+    std::size_t word = static_cast<std::size_t>(index) >> 6;
+    if (word >= words.size()) words.resize(word + 1, 0);
+
+    std::uint64_t bit = std::uint64_t(1) << (index & 63);
+    if (words[word] & bit) return false;
+
+    words[word] |= bit;
+    ++count;
+    return true;
+}
+
+bool SortedIndexSet::remove(int index) {
+    if (!contains(index)) return false;
+
+    words[static_cast<std::size_t>(index) >> 6] &= ~(std::uint64_t(1) << (index & 63));
+    --count;
+    return true;
+}
+
+void SortedIndexSet::clear() {
+    // keep the allocation; the next run usually has the same size
+    std::fill(words.begin(), words.end(), 0);
+    count = 0;
+}
+
+void SortedIndexHistory::clear() {
+    log.clear();
+    frameEnd.clear();
+}
+
+std::vector<int> SortedIndexHistory::frameEntries(int frame) const {
+    if (frame < 0 || frame >= frameCount()) return {};
+    int begin = frame == 0 ? 0 : frameEnd[frame - 1];
+    return std::vector<int>(log.begin() + begin, log.begin() + frameEnd[frame]);
+}
+
+void SortedIndexHistory::seek(int frame, SortedIndexSet& view) const {
+    if (frame < 0 || frame >= frameCount()) return;
+
+    // Log entries are unique within a run, so the view's size is exactly how many of them
+    // it currently holds.
+    int target = frameEnd[frame];
+    while (view.size() < target) view.insert(log[view.size()]);
+    while (view.size() > target) view.remove(log[view.size() - 1]);
+}
@@ -0,0 +1,66 @@
+#ifndef SORTEDINDEXSET_H
+#define SORTEDINDEXSET_H
+
+#include <cstdint>
+#include <vector>
+
+// Dense bitset of array indices that have reached their final position.
+// Replaces QSet<int>: contains() is a single bit test, so colouring a bar costs O(1)
+// without hashing.
+class SortedIndexSet
+{
+public:
+    // Returns true if the index was not already in the set.
+    bool insert(int index);
+    bool remove(int index);
+    void clear();
+
+    inline bool contains(int index) const {
+        if (index < 0) return false;
+        std::size_t word = static_cast<std::size_t>(index) >> 6;
+        return word < words.size() && ((words[word] >> (index & 63)) & 1u);
+    }
+
+    bool isEmpty() const { return count == 0; }
+    int size() const { return count; }
+
+private:
+    std::vector<std::uint64_t> words;
+    int count = 0;
+};
+
+// Per-frame history of a SortedIndexSet stored as changes only.
+// Within one run indices are only ever added, so every frame is a prefix of a single
+// append-only log of newly settled indices; a frame costs one int instead of a full copy.
+class SortedIndexHistory
+{
+public:
+    void clear();
+
+    // Log an index that was newly inserted into the live set (insert() returned true).
+    void record(int index) { log.push_back(index); }
+
+    // Close the current frame: everything logged so far belongs to it.
+    void markFrame() { frameEnd.push_back(static_cast<int>(log.size())); }
+
+    int frameCount() const { return static_cast<int>(frameEnd.size()); }
+
+    // Indices logged since the last markFrame().
+    int pendingCount() const {
+        return static_cast<int>(log.size()) - (frameEnd.empty() ? 0 : frameEnd.back());
+    }
+
+    // Indices that became sorted during 'frame'.
+    std::vector<int> frameEntries(int frame) const;
+
+    // Bring 'view' to the state of 'frame' by replaying or undoing only the entries between
+    // its current state and the target, so scrubbing to a neighbouring frame is O(1) amortized.
+    // 'view' must only ever be modified through seek() (or cleared).
+    void seek(int frame, SortedIndexSet& view) const;
+
+private:
+    std::vector<int> log;
+    std::vector<int> frameEnd;
+};
+
+#endif // SORTEDINDEXSET_H
@@ -0,0 +1,313 @@
+#include "sortengine.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* algorithmName(SortAlgorithm alg) {
+    switch (alg) {
+    case SortAlgorithm::Bubble:    return "Bubble Sort";
+    case SortAlgorithm::Insertion: return "Insertion Sort";
+    case SortAlgorithm::Selection: return "Selection Sort";
+    case SortAlgorithm::Quick:     return "Quick Sort";
+    case SortAlgorithm::Quick3:    return "3-Way Quick Sort";
+    case SortAlgorithm::Merge:     return "Merge Sort";
+    case SortAlgorithm::Heap:      return "Heap Sort";
+    case SortAlgorithm::Shell:     return "Shell Sort";
+    case SortAlgorithm::Tim:       return "Tim Sort";
+    case SortAlgorithm::Radix:     return "Radix Sort";
+    case SortAlgorithm::Gnome:     return "Gnome Sort";
+    case SortAlgorithm::Network:   return "Sorting Network";
+    case SortAlgorithm::Bitonic:   return "Bitonic Sort";
+    case SortAlgorithm::Counting:  return "Counting Sort";
+    case SortAlgorithm::Bucket:    return "Bucket Sort";
+    case SortAlgorithm::DualPivot: return "Dual-Pivot Quick Sort";
+    case SortAlgorithm::BlockMerge: return "Block Merge Sort";
+    case SortAlgorithm::NaturalMerge: return "Natural Merge Sort";
+    }
+    return "";
+}
+
+const std::vector<SortAlgorithm>& allAlgorithms() {
+    static const std::vector<SortAlgorithm> all = {
+        SortAlgorithm::Bubble, SortAlgorithm::Insertion, SortAlgorithm::Selection, SortAlgorithm::Quick,
+        SortAlgorithm::Quick3, SortAlgorithm::Merge, SortAlgorithm::Heap, SortAlgorithm::Shell,
+        SortAlgorithm::Tim, SortAlgorithm::Radix, SortAlgorithm::Gnome, SortAlgorithm::Network,
+        SortAlgorithm::Bitonic, SortAlgorithm::Counting, SortAlgorithm::Bucket, SortAlgorithm::DualPivot,
+        SortAlgorithm::BlockMerge, SortAlgorithm::NaturalMerge
+    };
+    return all;
+}
+
+bool algorithmFromName(const std::string& name, SortAlgorithm& out) {
+    for (SortAlgorithm alg : allAlgorithms()) {
+        if (name == algorithmName(alg)) {
+            out = alg;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* algorithmKey(SortAlgorithm alg) {
+    switch (alg) {
+    case SortAlgorithm::Bubble:    return "bubble";
+    case SortAlgorithm::Insertion: return "insertion";
+    case SortAlgorithm::Selection: return "selection";
+    case SortAlgorithm::Quick:     return "quick";
+    case SortAlgorithm::Quick3:    return "quick3";
+    case SortAlgorithm::Merge:     return "merge";
+    case SortAlgorithm::Heap:      return "heap";
+    case SortAlgorithm::Shell:     return "shell";
+    case SortAlgorithm::Tim:       return "tim";
+    case SortAlgorithm::Radix:     return "radix";
+    case SortAlgorithm::Gnome:     return "gnome";
+    case SortAlgorithm::Network:   return "network";
+    case SortAlgorithm::Bitonic:   return "bitonic";
+    case SortAlgorithm::Counting:  return "counting";
+    case SortAlgorithm::Bucket:    return "bucket";
+    case SortAlgorithm::DualPivot: return "dualpivot";
+    case SortAlgorithm::BlockMerge: return "blockmerge";
+    case SortAlgorithm::NaturalMerge: return "natural";
+    }
+    return "";
+}
+
+bool algorithmFromKey(const std::string& key, SortAlgorithm& out) {
+    for (SortAlgorithm alg : allAlgorithms()) {
+        if (key == algorithmKey(alg)) {
+            out = alg;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* pivotStrategyName(PivotStrategy p) {
+    switch (p) {
+    case PivotStrategy::Last:            return "Last";
+    case PivotStrategy::Random:          return "Random";
+    case PivotStrategy::MedianOf3:       return "Median of 3";
+    case PivotStrategy::Ninther:         return "Ninther";
+    case PivotStrategy::MedianOfMedians: return "Median of Medians";
+    }
+    return "";
+}
+
+const char* pivotStrategyKey(PivotStrategy p) {
+    switch (p) {
+    case PivotStrategy::Last:            return "last";
+    case PivotStrategy::Random:          return "random";
+    case PivotStrategy::MedianOf3:       return "median3";
+    case PivotStrategy::Ninther:         return "ninther";
+    case PivotStrategy::MedianOfMedians: return "mom";
+    }
+    return "";
+}
+
+const std::vector<PivotStrategy>& allPivotStrategies() {
+    static const std::vector<PivotStrategy> all = {
+        PivotStrategy::Last, PivotStrategy::Random, PivotStrategy::MedianOf3, PivotStrategy::Ninther,
+        PivotStrategy::MedianOfMedians
+    };
+    return all;
+}
+
+bool pivotStrategyFromName(const std::string& name, PivotStrategy& out) {
+    for (PivotStrategy p : allPivotStrategies()) {
+        if (name == pivotStrategyName(p)) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool pivotStrategyFromKey(const std::string& key, PivotStrategy& out) {
+    for (PivotStrategy p : allPivotStrategies()) {
+        if (key == pivotStrategyKey(p)) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* smallSortName(SmallSort s) {
+    switch (s) {
+    case SmallSort::Insertion: return "Insertion Sort";
+    case SmallSort::Network:   return "Sorting Network";
+    case SmallSort::Simd:      return "SIMD Network";
+    }
+    return "";
+}
+
+const char* smallSortKey(SmallSort s) {
+    switch (s) {
+    case SmallSort::Insertion: return "insertion";
+    case SmallSort::Network:   return "network";
+    case SmallSort::Simd:      return "simd";
+    }
+    return "";
+}
+
+const std::vector<SmallSort>& allSmallSorts() {
+    static const std::vector<SmallSort> all = { SmallSort::Insertion, SmallSort::Network, SmallSort::Simd };
+    return all;
+}
+
+bool smallSortFromName(const std::string& name, SmallSort& out) {
+    for (SmallSort s : allSmallSorts()) {
+        if (name == smallSortName(s)) {
+            out = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool smallSortFromKey(const std::string& key, SmallSort& out) {
+    for (SmallSort s : allSmallSorts()) {
+        if (key == smallSortKey(s)) {
+            out = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* heapVariantName(HeapVariant h) {
+    switch (h) {
+    case HeapVariant::Binary:   return "Binary";
+    case HeapVariant::BottomUp: return "Binary, bottom-up";
+    case HeapVariant::FourAry:  return "4-ary, bottom-up";
+    case HeapVariant::EightAry: return "8-ary, bottom-up";
+    }
+    return "";
+}
+
+const char* heapVariantKey(HeapVariant h) {
+    switch (h) {
+    case HeapVariant::Binary:   return "binary";
+    case HeapVariant::BottomUp: return "bottomup";
+    case HeapVariant::FourAry:  return "4ary";
+    case HeapVariant::EightAry: return "8ary";
+    }
+    return "";
+}
+
+const std::vector<HeapVariant>& allHeapVariants() {
+    static const std::vector<HeapVariant> all = {
+        HeapVariant::Binary, HeapVariant::BottomUp, HeapVariant::FourAry, HeapVariant::EightAry
+    };
+    return all;
+}
+
+bool heapVariantFromName(const std::string& name, HeapVariant& out) {
+    for (HeapVariant h : allHeapVariants()) {
+        if (name == heapVariantName(h)) {
+            out = h;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool heapVariantFromKey(const std::string& key, HeapVariant& out) {
+    for (HeapVariant h : allHeapVariants()) {
+        if (key == heapVariantKey(h)) {
+            out = h;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* gapSequenceName(GapSequence g) {
+    switch (g) {
+    case GapSequence::Shell:     return "Shell (n/2, n/4, ...)";
+    case GapSequence::Knuth:     return "Knuth (1, 4, 13, 40, ...)";
+    case GapSequence::Sedgewick: return "Sedgewick (1, 8, 23, 77, ...)";
+    case GapSequence::Tokuda:    return "Tokuda (1, 4, 9, 20, ...)";
+    case GapSequence::Ciura:     return "Ciura (1, 4, 10, 23, ...)";
+    }
+    return "";
+}
+
+const char* gapSequenceKey(GapSequence g) {
+    switch (g) {
+    case GapSequence::Shell:     return "shell";
+    case GapSequence::Knuth:     return "knuth";
+    case GapSequence::Sedgewick: return "sedgewick";
+    case GapSequence::Tokuda:    return "tokuda";
+    case GapSequence::Ciura:     return "ciura";
+    }
+    return "";
+}
+
+const std::vector<GapSequence>& allGapSequences() {
+    static const std::vector<GapSequence> all = {
+        GapSequence::Shell, GapSequence::Knuth, GapSequence::Sedgewick, GapSequence::Tokuda, GapSequence::Ciura
+    };
+    return all;
+}
+
+bool gapSequenceFromName(const std::string& name, GapSequence& out) {
+    for (GapSequence g : allGapSequences()) {
+        if (name == gapSequenceName(g)) {
+            out = g;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool gapSequenceFromKey(const std::string& key, GapSequence& out) {
+    for (GapSequence g : allGapSequences()) {
+        if (key == gapSequenceKey(g)) {
+            out = g;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> shellGaps(GapSequence g, int n) {
+    std::vector<int> gaps;
+    if (n < 2) return gaps;
+    if (g == GapSequence::Shell) {
+        for (int gap = n / 2; gap > 0; gap /= 2) gaps.push_back(gap);
+        return gaps;
+    }
+
+    // the other sequences grow from 1; every term below n is used
+    auto add = [&](long long gap) {
+        if (gap >= n) return false;
+        if (gaps.empty() || gap > gaps.back()) gaps.push_back(static_cast<int>(gap));
+        return true;
+    };
+    switch (g) {
+    case GapSequence::Shell:
+        break;
+    case GapSequence::Knuth:
+        // Knuth stops at the last term below n/3; larger gaps barely move anything
+        for (long long h = 1; (h == 1 || 3 * h < n) && add(h); h = 3 * h + 1) {}
+        break;
+    case GapSequence::Sedgewick:
+        // 1, then 4^k + 3 * 2^(k-1) + 1
+        add(1);
+        for (int k = 1; add((1LL << (2 * k)) + 3 * (1LL << (k - 1)) + 1); ++k) {}
+        break;
+    case GapSequence::Tokuda:
+        // ceil(h_k) for h_1 = 1, h_k = 2.25 * h_(k-1) + 1
+        for (double h = 1; add(static_cast<long long>(std::ceil(h))); h = 2.25 * h + 1) {}
+        break;
+    case GapSequence::Ciura: {
+        static const int measured[] = { 1, 4, 10, 23, 57, 132, 301, 701, 1750 };
+        for (int m : measured) add(m);
+        for (long long h = 1750 * 9 / 4; add(h); h = h * 9 / 4) {}
+        break;
+    }
+    }
+    std::reverse(gaps.begin(), gaps.end());
+    return gaps;
+}
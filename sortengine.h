@@ -0,0 +1,1531 @@
+#ifndef SORTENGINE_H
+#define SORTENGINE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+#include "bitonicsort.h"
+#include "countingsort.h"
+#include "losertree.h"
+#include "simdsort.h"
+#include "sortnetwork.h"
+
+enum class SortAlgorithm { Bubble, Insertion, Selection, Quick, Quick3, Merge, Heap, Shell, Tim, Radix, Gnome, Network, Bitonic, Counting, Bucket, DualPivot, BlockMerge, NaturalMerge };
+
+// Display names match the entries of MainWindow's algorithm box ("Bubble Sort", ...).
+const char* algorithmName(SortAlgorithm alg);
+const std::vector<SortAlgorithm>& allAlgorithms();
+bool algorithmFromName(const std::string& name, SortAlgorithm& out);
+// Short lowercase keys used on the command line ("bubble", "quick", ...).
+const char* algorithmKey(SortAlgorithm alg);
+bool algorithmFromKey(const std::string& key, SortAlgorithm& out);
+
+// How the quick sorts pick their pivot; the chosen element is swapped to the right end first.
+enum class PivotStrategy { Last, Random, MedianOf3, Ninther, MedianOfMedians };
+
+const char* pivotStrategyName(PivotStrategy p);  // "Median of 3"
+const char* pivotStrategyKey(PivotStrategy p);   // "median3"
+const std::vector<PivotStrategy>& allPivotStrategies();
+bool pivotStrategyFromName(const std::string& name, PivotStrategy& out);
+bool pivotStrategyFromKey(const std::string& key, PivotStrategy& out);
+
+// What finishes a range shorter than the cutoff. Networks are compiled in for up to
+// kMaxFixedNetwork (32) elements and the SIMD kernel takes up to kSimdBlock (64); longer ranges
+// below the cutoff fall back to insertion sort.
+enum class SmallSort { Insertion, Network, Simd };
+
+const char* smallSortName(SmallSort s);  // "SIMD Network"
+const char* smallSortKey(SmallSort s);   // "simd"
+const std::vector<SmallSort>& allSmallSorts();
+bool smallSortFromName(const std::string& name, SmallSort& out);
+bool smallSortFromKey(const std::string& key, SmallSort& out);
+
+// Heap sort's heap. The bottom-up variants sift the Floyd/Wegener way: down to a leaf along the
+// larger children, then back up to where the key belongs. The 4- and 8-ary heaps are also laid
+// out so every group of siblings sits in one cache line.
+enum class HeapVariant { Binary, BottomUp, FourAry, EightAry };
+
+const char* heapVariantName(HeapVariant h);  // "4-ary, bottom-up"
+const char* heapVariantKey(HeapVariant h);   // "4ary"
+const std::vector<HeapVariant>& allHeapVariants();
+bool heapVariantFromName(const std::string& name, HeapVariant& out);
+bool heapVariantFromKey(const std::string& key, HeapVariant& out);
+
+// Shell sort's gaps. Shell's own halving is O(n^2) in the worst case; Knuth's is O(n^1.5),
+// Sedgewick's (1986) O(n^4/3), and Tokuda's and Ciura's were fitted to measurements and are the
+// fastest known in practice (Ciura's measured prefix is extended by factors of 2.25).
+enum class GapSequence { Shell, Knuth, Sedgewick, Tokuda, Ciura };
+
+const char* gapSequenceName(GapSequence g);  // "Knuth (1, 4, 13, 40, ...)"
+const char* gapSequenceKey(GapSequence g);   // "knuth"
+const std::vector<GapSequence>& allGapSequences();
+bool gapSequenceFromName(const std::string& name, GapSequence& out);
+bool gapSequenceFromKey(const std::string& key, GapSequence& out);
+
+// The gaps of 'g' for n elements, largest first and ending with 1 (empty when n < 2).
+std::vector<int> shellGaps(GapSequence g, int n);
+
+// Tuning that does not change what an algorithm is, only how it runs.
+struct SortOptions {
+    PivotStrategy pivot = PivotStrategy::Last;
+    HeapVariant heap = HeapVariant::Binary;
+    GapSequence gaps = GapSequence::Shell;
+    // Quick, 3-way quick and merge sort stop recursing on ranges shorter than this and finish them
+    // with smallSort; radix sort does so for the whole input. 0 keeps the textbook algorithms.
+    int cutoff = 0;
+    SmallSort smallSort = SmallSort::Insertion;
+};
+
+/*
+ * Sorting engine: every algorithm runs to completion on a plain vector, with no widgets involved,
+ * so several can run at once on worker threads.
+ *
+ * Each algorithm is written once, as a template over a tracing policy (the Probe) that observes it:
+ *   probe.compare(i, j)        before an element comparison (j may be -1 when comparing with a held key)
+ *   probe.step(a, i, j)        after writing a[i] (and a[j] for a swap; otherwise j is -1)
+ *   probe.mark(kind, x, y, z)  what the algorithm is doing, see SortMark
+ *   probe.depth(d)             the quick sorts' explicit stack now holds d ranges
+ *
+ * Two instantiations matter:
+ *   NullTracer       every hook is an empty inline function, so the instantiation is the bare
+ *                    algorithm; this is the one that is timed
+ *   RecordingTracer  records the events; the GUI replays them one tick at a time
+ * Other probes (race, command line) derive from NullTracer and hide only the hooks they need.
+ *
+ * Where an algorithm has a production path (SIMD kernels, k-way merges, parallel passes) that
+ * reports no events, it takes it whenever Probe::records is false: for NullTracer and every probe
+ * derived from it, so races time the code that ships. A probe that needs every write, to replay
+ * or store the run, sets records to true and gets the traced path.
+ */
+
+enum class SortMark : unsigned char {
+    Key,         // x: element lifted out as the key of an insertion
+    Partition,   // [x, y] is partitioned around the pivot at z
+    PivotPlaced, // x: the pivot reached its final position
+    MergeBegin,  // merging [x, y) with [y, z)
+    MergeRuns,   // k-way merging the sorted runs of z elements that tile [x, y)
+    Rotate,      // [x, y) and [y, z) swap places, keeping their order
+    MergeEnd,    // [x, y) is merged
+    Sorted,      // [x, y) holds its final values
+    Run,         // insertion-sorting the run [x, y)
+    NaturalRun,  // [x, y) is a run the input already had (z = 1: descending, about to be reversed)
+    MergePass,   // a bottom-up pass merges the x runs left in pairs
+    Gap,         // gap x starts
+    HeapBuilt,   // the max-heap is built, extraction starts
+    DigitPass,   // radix pass for digit place x
+    CountDigit,  // element x has digit y (counting sort: key y above the minimum; bucket sort: goes to bucket y)
+    Accumulate,  // prefix sum up to bucket x
+    Place,       // element x goes to bucket slot y
+    EqualRange,  // [x, y) holds the keys equal to the pivot, all in their final place
+    PivotChosen, // x is the pivot of the range ending at y and is about to be swapped to y (dual-pivot: to the end y)
+    SmallRange,  // [x, y) is below the cutoff: insertion sort (z = 0), a sorting network (z = 1) or the SIMD kernel (z = 2) follows
+    NetworkLayer, // comparator layer x of y starts
+    BitonicStage, // bitonic stage on blocks of x: pairs at distance y, or each element with its mirror in the block (z = 1)
+    DualPartition, // [x, y] is partitioned around the pivots at x and y; z = 1: gathering the keys equal to them
+    DualRegions    // dual-pivot partition of [left, right]: (left, x) < the left pivot (== when gathering), [x, y)
+                   // between, (z, right) > the right pivot (==), y is next
+};
+
+namespace SortEngine {
+
+// Observes nothing; compiles down to the plain algorithm.
+struct NullTracer {
+    static constexpr bool records = false;
+
+    void compare(int, int) {}
+    void step(const std::vector<int>&, int, int = -1) {}
+    void mark(SortMark, int = -1, int = -1, int = -1) {}
+    void depth(int) {}
+};
+
+// One recorded event; see the hooks above.
+struct SortStep {
+    enum class Kind : unsigned char { Compare, Write, Mark };
+
+    Kind kind;
+    SortMark mark = SortMark::Key; // Kind::Mark only
+    int x = -1, y = -1, z = -1;
+    int vx = 0, vy = 0;            // Kind::Write: values written at x and y
+};
+
+// Records every event of a run, for replaying it step by step.
+struct RecordingTracer : NullTracer {
+    static constexpr bool records = true;
+
+    std::vector<SortStep> steps;
+    int peakDepth = 0; // not an event: only the maximum is kept
+
+    void compare(int i, int j) {
+        steps.push_back({ SortStep::Kind::Compare, SortMark::Key, i, j });
+    }
+    void step(const std::vector<int>& a, int i, int j = -1) {
+        steps.push_back({ SortStep::Kind::Write, SortMark::Key, i, j, -1, a[i], j >= 0 ? a[j] : 0 });
+    }
+    void mark(SortMark kind, int x = -1, int y = -1, int z = -1) {
+        steps.push_back({ SortStep::Kind::Mark, kind, x, y, z });
+    }
+    void depth(int d) { peakDepth = std::max(peakDepth, d); }
+};
+
+template <typename Probe>
+void bubbleSort(std::vector<int>& a, Probe& probe) {
+    const int n = static_cast<int>(a.size());
+    for (int i = 0; i < n - 1; ++i) {
+        for (int j = 0; j < n - i - 1; ++j) {
+            probe.compare(j, j + 1);
+            if (a[j] > a[j + 1]) {
+                std::swap(a[j], a[j + 1]);
+                probe.step(a, j, j + 1);
+            }
+        }
+        probe.mark(SortMark::Sorted, n - i - 1, n - i);
+    }
+}
+
+template <typename Probe>
+void insertionSort(std::vector<int>& a, Probe& probe) {
+    const int n = static_cast<int>(a.size());
+    for (int i = 1; i < n; ++i) {
+        probe.mark(SortMark::Key, i);
+        int key = a[i];
+        int j = i - 1;
+        while (j >= 0) {
+            probe.compare(j, -1);
+            if (!(a[j] > key)) break;
+            a[j + 1] = a[j];
+            probe.step(a, j + 1);
+            --j;
+        }
+        a[j + 1] = key;
+        probe.step(a, j + 1);
+    }
+}
+
+template <typename Probe>
+void selectionSort(std::vector<int>& a, Probe& probe) {
+    const int n = static_cast<int>(a.size());
+    for (int i = 0; i < n - 1; ++i) {
+        int minIndex = i;
+        for (int j = i + 1; j < n; ++j) {
+            probe.compare(j, minIndex);
+            if (a[j] < a[minIndex]) minIndex = j;
+        }
+        if (minIndex != i) {
+            std::swap(a[i], a[minIndex]);
+            probe.step(a, i, minIndex);
+        }
+        probe.mark(SortMark::Sorted, i, i + 1);
+    }
+}
+
+// Finishes a[left, right), a range shorter than the cutoff, without further recursion.
+template <typename Probe>
+void sortSmallRange(std::vector<int>& a, int left, int right, SmallSort kind, Probe& probe) {
+    const int size = right - left;
+    const bool simd = kind == SmallSort::Simd && size <= kSimdBlock;
+    const bool network = (kind == SmallSort::Network && size <= kMaxFixedNetwork) || simd;
+    probe.mark(SortMark::SmallRange, left, right, simd ? 2 : network ? 1 : 0);
+
+    if (network) {
+        // untraced: the unrolled, branchless kernel; traced: the comparators of the network for
+        // this size one at a time (vector lanes have no single-step view, so SIMD shows those too)
+        if constexpr (!Probe::records) {
+            if (simd) simdSortSmall(a.data() + left, size);
+            else networkKernels[size](a.data() + left);
+        }
+        else {
+            for (const NetworkComparator& c : sortingNetwork(size)) {
+                probe.compare(left + c.a, left + c.b);
+                if (a[left + c.b] < a[left + c.a]) {
+                    std::swap(a[left + c.a], a[left + c.b]);
+                    probe.step(a, left + c.a, left + c.b);
+                }
+            }
+        }
+        return;
+    }
+
+    for (int i = left + 1; i < right; ++i) {
+        int key = a[i];
+        int j = i;
+        while (j > left) {
+            probe.compare(j - 1, -1);
+            if (!(a[j - 1] > key)) break;
+            a[j] = a[j - 1];
+            probe.step(a, j);
+            --j;
+        }
+        a[j] = key;
+        probe.step(a, j);
+    }
+}
+
+// Index of the median of a[i], a[j], a[k] in at most three comparisons.
+template <typename Probe>
+int medianOf3(const std::vector<int>& a, int i, int j, int k, Probe& probe) {
+    probe.compare(i, j);
+    if (a[i] < a[j]) {
+        probe.compare(j, k);
+        if (a[j] < a[k]) return j;
+        probe.compare(i, k);
+        return a[i] < a[k] ? k : i;
+    }
+    probe.compare(j, k);
+    if (a[k] < a[j]) return j;
+    probe.compare(i, k);
+    return a[k] < a[i] ? k : i;
+}
+
+// Index of the k-th smallest of a[idx[...]], by median of medians: groups of five are
+// insertion-sorted, their medians select a pivot recursively, and only one side is kept.
+// Works on indices so the array is untouched until the chosen pivot is swapped into place.
+template <typename Probe>
+int selectIndex(const std::vector<int>& a, std::vector<int> idx, int k, Probe& probe) {
+    auto sortGroup = [&](int from, int to) {
+        for (int x = from + 1; x < to; ++x) {
+            for (int y = x; y > from; --y) {
+                probe.compare(idx[y - 1], idx[y]);
+                if (!(a[idx[y]] < a[idx[y - 1]])) break;
+                std::swap(idx[y], idx[y - 1]);
+            }
+        }
+    };
+
+    while (true) {
+        const int count = static_cast<int>(idx.size());
+        if (count <= 5) {
+            sortGroup(0, count);
+            return idx[k];
+        }
+
+        std::vector<int> medians;
+        for (int g = 0; g < count; g += 5) {
+            int end = std::min(g + 5, count);
+            sortGroup(g, end);
+            medians.push_back(idx[(g + end - 1) / 2]);
+        }
+        const int pivot = selectIndex(a, medians, static_cast<int>(medians.size()) / 2, probe);
+
+        std::vector<int> less, greater;
+        int equal = 0;
+        for (int x : idx) {
+            probe.compare(x, pivot);
+            if (a[x] < a[pivot]) less.push_back(x);
+            else if (a[pivot] < a[x]) greater.push_back(x);
+            else ++equal;
+        }
+        if (k < static_cast<int>(less.size())) {
+            idx.swap(less);
+        }
+        else if (k < static_cast<int>(less.size()) + equal) {
+            return pivot;
+        }
+        else {
+            k -= static_cast<int>(less.size()) + equal;
+            idx.swap(greater);
+        }
+    }
+}
+
+// Fixed-seed generator for PivotStrategy::Random, so a run can be replayed exactly.
+struct PivotRng {
+    unsigned long long state = 0x2545F4914F6CDD1Dull;
+    int below(int n) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<int>((state >> 33) % static_cast<unsigned long long>(n));
+    }
+};
+
+// Picks the pivot of a[left, right] and swaps it to 'right', where both partitions expect it.
+template <typename Probe>
+void placePivot(std::vector<int>& a, int left, int right, PivotStrategy strategy, PivotRng& rng, Probe& probe) {
+    const int size = right - left + 1;
+    int p = right;
+    switch (strategy) {
+    case PivotStrategy::Last:
+        return;
+    case PivotStrategy::Random:
+        p = left + rng.below(size);
+        break;
+    case PivotStrategy::MedianOf3:
+        if (size >= 3) p = medianOf3(a, left, left + size / 2, right, probe);
+        break;
+    case PivotStrategy::Ninther:
+        // Tukey's ninther: the median of three medians of three, spread over the range
+        if (size >= 40) {
+            const int step = size / 8, mid = left + size / 2;
+            p = medianOf3(a, medianOf3(a, left, left + step, left + 2 * step, probe),
+                             medianOf3(a, mid - step, mid, mid + step, probe),
+                             medianOf3(a, right - 2 * step, right - step, right, probe), probe);
+        }
+        else if (size >= 3) {
+            p = medianOf3(a, left, left + size / 2, right, probe);
+        }
+        break;
+    case PivotStrategy::MedianOfMedians: {
+        std::vector<int> idx(size);
+        for (int k = 0; k < size; ++k) idx[k] = left + k;
+        p = selectIndex(a, std::move(idx), size / 2, probe);
+        break;
+    }
+    }
+
+    probe.mark(SortMark::PivotChosen, p, right);
+    if (p != right) {
+        std::swap(a[p], a[right]);
+        probe.step(a, p, right);
+    }
+}
+
+// Pushes the two sides of a partition, the larger first: the smaller one is popped next, so the
+// stack stays O(log n) deep however unbalanced the partitions are.
+template <typename Probe>
+void pushSides(std::vector<std::pair<int, int>>& stack, std::pair<int, int> low, std::pair<int, int> high, Probe& probe) {
+    if (low.second - low.first < high.second - high.first) std::swap(low, high);
+    stack.push_back(low);
+    stack.push_back(high);
+    probe.depth(static_cast<int>(stack.size()));
+}
+
+// The same for the three parts of a dual-pivot partition.
+template <typename Probe>
+void pushSides(std::vector<std::pair<int, int>>& stack, std::pair<int, int> low, std::pair<int, int> middle,
+               std::pair<int, int> high, Probe& probe) {
+    std::pair<int, int> sides[] = { low, middle, high };
+    std::sort(std::begin(sides), std::end(sides), [](const auto& x, const auto& y) { return x.second - x.first > y.second - y.first; });
+    for (const auto& side : sides) stack.push_back(side);
+    probe.depth(static_cast<int>(stack.size()));
+}
+
+// Picks the two pivots of a[left, right] and moves them to the ends, the smaller to 'left'. Last
+// keeps the ends, like Yaroslavskiy's original; Random takes two random elements; the median
+// strategies take the second and fourth of five spread samples, like the JDK.
+template <typename Probe>
+void placeDualPivots(std::vector<int>& a, int left, int right, PivotStrategy strategy, PivotRng& rng, Probe& probe) {
+    const int size = right - left + 1;
+    int p = left, q = right;
+    if (strategy == PivotStrategy::Random) {
+        p = left + rng.below(size);
+        q = left + rng.below(size - 1);
+        if (q >= p) ++q;
+    }
+    else if (strategy != PivotStrategy::Last && size >= 8) {
+        const int seventh = size / 7;
+        int e[5];
+        e[2] = left + size / 2;
+        e[1] = e[2] - seventh;
+        e[0] = e[1] - seventh;
+        e[3] = e[2] + seventh;
+        e[4] = e[3] + seventh;
+        for (int i = 1; i < 5; ++i) {
+            for (int j = i; j > 0; --j) {
+                probe.compare(e[j - 1], e[j]);
+                if (!(a[e[j]] < a[e[j - 1]])) break;
+                std::swap(a[e[j - 1]], a[e[j]]);
+                probe.step(a, e[j - 1], e[j]);
+            }
+        }
+        p = e[1];
+        q = e[3];
+    }
+
+    probe.mark(SortMark::PivotChosen, q, right);
+    if (q != right) {
+        std::swap(a[q], a[right]);
+        probe.step(a, q, right);
+        if (p == right) p = q;
+    }
+    probe.mark(SortMark::PivotChosen, p, left);
+    if (p != left) {
+        std::swap(a[p], a[left]);
+        probe.step(a, p, left);
+    }
+    probe.compare(left, right);
+    if (a[right] < a[left]) {
+        std::swap(a[left], a[right]);
+        probe.step(a, left, right);
+    }
+}
+
+// Lomuto partition around the pivot moved to the last element, driven by an explicit stack.
+template <typename Probe>
+void quickSort(std::vector<int>& a, Probe& probe, const SortOptions& options = {}) {
+    std::vector<std::pair<int, int>> stack;
+    PivotRng rng;
+    if (!a.empty()) stack.push_back({ 0, static_cast<int>(a.size()) - 1 });
+
+    while (!stack.empty()) {
+        auto [left, right] = stack.back();
+        stack.pop_back();
+        if (left >= right) {
+            if (left == right) probe.mark(SortMark::Sorted, left, left + 1);
+            continue;
+        }
+        if (right - left + 1 < options.cutoff) {
+            sortSmallRange(a, left, right + 1, options.smallSort, probe);
+            probe.mark(SortMark::Sorted, left, right + 1);
+            continue;
+        }
+
+        placePivot(a, left, right, options.pivot, rng, probe);
+        probe.mark(SortMark::Partition, left, right, right);
+        int pivotValue = a[right];
+        int i = left - 1;
+        for (int j = left; j < right; ++j) {
+            probe.compare(j, right);
+            if (a[j] < pivotValue) {
+                ++i;
+                std::swap(a[i], a[j]);
+                probe.step(a, i, j);
+            }
+        }
+        std::swap(a[i + 1], a[right]);
+        probe.step(a, i + 1, right);
+
+        int pivotIndex = i + 1;
+        probe.mark(SortMark::PivotPlaced, pivotIndex);
+        pushSides(stack, { left, pivotIndex - 1 }, { pivotIndex + 1, right }, probe);
+    }
+}
+
+// Three-way (Dutch national flag) partition around the pivot moved to the last element: < pivot, == pivot, > pivot.
+// Keys equal to the pivot are final after one pass, so duplicates cost nothing further and
+// all-equal input is linear instead of quadratic. Every swap is reported, self-swaps included,
+// as step(lt, i) for a smaller key and step(gt, i) for a larger one.
+template <typename Probe>
+void quickSort3(std::vector<int>& a, Probe& probe, const SortOptions& options = {}) {
+    std::vector<std::pair<int, int>> stack;
+    PivotRng rng;
+    if (!a.empty()) stack.push_back({ 0, static_cast<int>(a.size()) - 1 });
+
+    while (!stack.empty()) {
+        auto [left, right] = stack.back();
+        stack.pop_back();
+        if (left >= right) {
+            if (left == right) probe.mark(SortMark::Sorted, left, left + 1);
+            continue;
+        }
+        if (right - left + 1 < options.cutoff) {
+            sortSmallRange(a, left, right + 1, options.smallSort, probe);
+            probe.mark(SortMark::Sorted, left, right + 1);
+            continue;
+        }
+
+        placePivot(a, left, right, options.pivot, rng, probe);
+        probe.mark(SortMark::Partition, left, right, right);
+        const int pivotValue = a[right];
+        int lt = left, i = left, gt = right;
+        while (i <= gt) {
+            probe.compare(i, -1);
+            if (a[i] < pivotValue) {
+                std::swap(a[lt], a[i]);
+                probe.step(a, lt, i);
+                ++lt;
+                ++i;
+            }
+            else if (a[i] > pivotValue) {
+                std::swap(a[i], a[gt]);
+                probe.step(a, gt, i);
+                --gt;
+            }
+            else {
+                ++i;
+            }
+        }
+
+        probe.mark(SortMark::EqualRange, lt, gt + 1);
+        pushSides(stack, { left, lt - 1 }, { gt + 1, right }, probe);
+    }
+}
+
+template <typename Probe>
+void mergeRange(std::vector<int>& a, std::vector<int>& buffer, int left, int mid, int right, Probe& probe) {
+    // merges [left, mid) and [mid, right)
+    probe.mark(SortMark::MergeBegin, left, mid, right);
+    int i = left, j = mid, k = left;
+    while (i < mid && j < right) {
+        probe.compare(i, j);
+        buffer[k++] = (a[i] <= a[j]) ? a[i++] : a[j++];
+    }
+    while (i < mid) buffer[k++] = a[i++];
+    while (j < right) buffer[k++] = a[j++];
+
+    for (k = left; k < right; ++k) {
+        a[k] = buffer[k];
+        probe.step(a, k);
+    }
+    probe.mark(SortMark::MergeEnd, left, right);
+}
+
+// Inserts a[i] into the sorted a[start, i).
+template <typename Probe>
+void insertIntoRun(std::vector<int>& a, int start, int i, Probe& probe) {
+    probe.mark(SortMark::Key, i);
+    int key = a[i];
+    int j = i;
+    while (j > start) {
+        probe.compare(j - 1, -1);
+        if (!(a[j - 1] > key)) break;
+        a[j] = a[j - 1];
+        probe.step(a, j);
+        --j;
+    }
+    a[j] = key;
+    probe.step(a, j);
+}
+
+template <typename Probe>
+void mergeSortRange(std::vector<int>& a, std::vector<int>& buffer, int left, int right, Probe& probe,
+                    const SortOptions& options) {
+    // sorts [left, right)
+    if (right - left < 2) return;
+    if (right - left < options.cutoff) {
+        sortSmallRange(a, left, right, options.smallSort, probe);
+        return;
+    }
+    int mid = left + (right - left) / 2;
+    mergeSortRange(a, buffer, left, mid, probe, options);
+    mergeSortRange(a, buffer, mid, right, probe, options);
+    mergeRange(a, buffer, left, mid, right, probe);
+}
+
+template <typename Probe>
+void mergeSort(std::vector<int>& a, Probe& probe, const SortOptions& options = {}) {
+    std::vector<int> buffer(a.size());
+    mergeSortRange(a, buffer, 0, static_cast<int>(a.size()), probe, options);
+}
+
+template <typename Probe>
+void siftDown(std::vector<int>& a, int root, int size, Probe& probe) {
+    while (true) {
+        int largest = root;
+        int left = 2 * root + 1;
+        int right = 2 * root + 2;
+        if (left < size) {
+            probe.compare(left, largest);
+            if (a[left] > a[largest]) largest = left;
+        }
+        if (right < size) {
+            probe.compare(right, largest);
+            if (a[right] > a[largest]) largest = right;
+        }
+        if (largest == root) return;
+
+        std::swap(a[root], a[largest]);
+        probe.step(a, root, largest);
+        root = largest;
+    }
+}
+
+// Hint that *p is needed soon; never changes a result.
+inline void prefetchRead(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+    (void)p;
+#endif
+}
+
+// Sifts h[root] down the D-ary max-heap h[0, m) bottom-up: first to a leaf along the largest
+// children (D - 1 comparisons per level, none against the key), then up to where the key belongs,
+// which is rarely more than a level or two, and finally the path shifts up one level. h is
+// a.data() when traced, so the reported indices are a's.
+template <int D, typename Probe>
+void bottomUpSift(std::vector<int>& a, int* h, int root, int m, Probe& probe) {
+    int j = root;
+    while (true) {
+        const long long first = static_cast<long long>(D) * j + 1;
+        if (first >= m) break;
+        if constexpr (D > 2) {
+            // the grandchildren are the next level's siblings; fetch them while these are compared
+            const long long grand = D * first + 1;
+            for (long long g = grand; g < std::min<long long>(grand + D * D, m); g += 16) prefetchRead(h + g);
+        }
+        int best = static_cast<int>(first);
+        const int last = static_cast<int>(std::min<long long>(first + D, m));
+        for (int c = best + 1; c < last; ++c) {
+            probe.compare(c, best);
+            if (h[c] > h[best]) best = c;
+        }
+        j = best;
+    }
+
+    const int key = h[root];
+    while (j != root) {
+        probe.compare(j, root);
+        if (!(h[j] < key)) break;
+        j = (j - 1) / D;
+    }
+    int carry = key;
+    while (j != root) {
+        std::swap(carry, h[j]);
+        probe.step(a, j);
+        j = (j - 1) / D;
+    }
+    h[root] = carry;
+    probe.step(a, root);
+}
+
+template <int D, typename Probe>
+void bottomUpHeapSort(std::vector<int>& a, int* h, Probe& probe) {
+    const int n = static_cast<int>(a.size());
+    if (n < 2) return;
+    for (int k = (n - 2) / D; k >= 0; --k) bottomUpSift<D>(a, h, k, n, probe);
+    probe.mark(SortMark::HeapBuilt);
+    for (int size = n - 1; size > 0; --size) {
+        std::swap(h[0], h[size]);
+        probe.step(a, 0, size);
+        probe.mark(SortMark::Sorted, size, size + 1);
+        bottomUpSift<D>(a, h, 0, size, probe);
+    }
+}
+
+// Untraced, the heap is copied to a 64-byte aligned buffer, shifted by D - 1 so that the children
+// D * i + 1 .. D * i + D of every node start at a multiple of D and never straddle a cache line.
+template <int D, typename Probe>
+void dAryHeapSort(std::vector<int>& a, Probe& probe) {
+    if constexpr (!Probe::records) {
+        const int lineInts = 64 / sizeof(int);
+        std::vector<int> storage(a.size() + D - 1 + lineInts);
+        int* base = storage.data();
+        base += (lineInts - reinterpret_cast<std::uintptr_t>(base) / sizeof(int) % lineInts) % lineInts;
+        int* h = base + D - 1;
+        std::copy(a.begin(), a.end(), h);
+        bottomUpHeapSort<D>(a, h, probe);
+        std::copy(h, h + a.size(), a.begin());
+    }
+    else {
+        bottomUpHeapSort<D>(a, a.data(), probe);
+    }
+}
+
+template <typename Probe>
+void heapSort(std::vector<int>& a, Probe& probe, const SortOptions& options = {}) {
+    switch (options.heap) {
+    case HeapVariant::Binary:   break;
+    case HeapVariant::BottomUp: bottomUpHeapSort<2>(a, a.data(), probe); return;
+    case HeapVariant::FourAry:  dAryHeapSort<4>(a, probe); return;
+    case HeapVariant::EightAry: dAryHeapSort<8>(a, probe); return;
+    }
+
+    // the textbook version: top-down sift, two comparisons per level
+    const int n = static_cast<int>(a.size());
+    for (int k = n / 2 - 1; k >= 0; --k) siftDown(a, k, n, probe);
+    probe.mark(SortMark::HeapBuilt);
+    for (int size = n - 1; size > 0; --size) {
+        std::swap(a[0], a[size]);
+        probe.step(a, 0, size);
+        probe.mark(SortMark::Sorted, size, size + 1);
+        siftDown(a, 0, size, probe);
+    }
+}
+
+template <typename Probe>
+void shellSort(std::vector<int>& a, Probe& probe, const SortOptions& options = {}) {
+    const int n = static_cast<int>(a.size());
+    for (int gap : shellGaps(options.gaps, n)) {
+        probe.mark(SortMark::Gap, gap);
+        for (int i = gap; i < n; ++i) {
+            probe.mark(SortMark::Key, i);
+            int key = a[i];
+            int j = i;
+            while (j >= gap) {
+                probe.compare(j - gap, -1);
+                if (!(a[j - gap] > key)) break;
+                a[j] = a[j - gap];
+                probe.step(a, j);
+                j -= gap;
+            }
+            a[j] = key;
+            probe.step(a, j);
+        }
+    }
+}
+
+// Merges the sorted runs of 'width' elements that tile a[left, right) through a loser tree,
+// comparing the heads of two runs per match, then copies the merge back.
+template <typename Probe>
+void mergeRuns(std::vector<int>& a, std::vector<int>& buffer, int left, int right, int width, Probe& probe) {
+    probe.mark(SortMark::MergeRuns, left, right, width);
+    const int runs = (right - left + width - 1) / width;
+    std::vector<int> pos(runs), end(runs);
+    for (int r = 0; r < runs; ++r) {
+        pos[r] = left + r * width;
+        end[r] = std::min(pos[r] + width, right);
+    }
+    auto before = [&](int r, int s) {
+        if (pos[r] == end[r] || pos[s] == end[s]) return pos[s] == end[s] && pos[r] != end[r];
+        probe.compare(pos[r], pos[s]);
+        return a[pos[r]] < a[pos[s]] || (a[pos[r]] == a[pos[s]] && r < s);
+    };
+
+    LoserTree tree;
+    tree.build(runs, before);
+    for (int k = left; k < right; ++k) {
+        const int w = tree.winner();
+        buffer[k] = a[pos[w]++];
+        tree.replay(before);
+    }
+    for (int k = left; k < right; ++k) {
+        a[k] = buffer[k];
+        probe.step(a, k);
+    }
+    probe.mark(SortMark::MergeEnd, left, right);
+}
+
+// Insertion-sorts the runs a[k * runSize, (k + 1) * runSize), the last one possibly shorter.
+template <typename Probe>
+void insertionSortRuns(std::vector<int>& a, int runSize, Probe& probe) {
+    const int n = static_cast<int>(a.size());
+    for (int start = 0; start < n; start += runSize) {
+        int end = std::min(start + runSize, n);
+        probe.mark(SortMark::Run, start, end);
+        for (int i = start + 1; i < end; ++i) insertIntoRun(a, start, i, probe);
+    }
+}
+
+// Insertion-sorted runs of 32, then k-way merge passes: kMergeWays runs at a time through a loser
+// tree, so two passes over the data merge 32768 runs where pairwise merging took fifteen.
+template <typename Probe>
+void timSort(std::vector<int>& a, Probe& probe) {
+    const int n = static_cast<int>(a.size());
+    const int runSize = 32;
+    insertionSortRuns(a, runSize, probe);
+
+    std::vector<int> buffer(a.size());
+    if constexpr (!Probe::records) {
+        mergeRunPasses(a.data(), buffer.data(), n, runSize, kMergeWays);
+        return;
+    }
+    for (long long width = runSize; width < n; width *= kMergeWays) {
+        // a group holding a single run is already in place
+        for (long long left = 0; left + width < n; left += width * kMergeWays) {
+            mergeRuns(a, buffer, static_cast<int>(left), static_cast<int>(std::min(left + width * kMergeWays, static_cast<long long>(n))),
+                      static_cast<int>(width), probe);
+        }
+    }
+}
+
+// Swaps the blocks a[first, middle) and a[middle, last). Traced, as three reversals, so every move
+// is a visible swap; untraced, through the buffer when the shorter block fits, else std::rotate.
+template <typename Probe>
+void rotateBlocks(std::vector<int>& a, std::vector<int>& buffer, int first, int middle, int last, Probe& probe) {
+    if (first == middle || middle == last) return;
+    probe.mark(SortMark::Rotate, first, middle, last);
+    if constexpr (!Probe::records) {
+        int* p = a.data();
+        const int left = middle - first, right = last - middle;
+        if (left <= right && left <= static_cast<int>(buffer.size())) {
+            std::copy(p + first, p + middle, buffer.data());
+            std::copy(p + middle, p + last, p + first);
+            std::copy(buffer.data(), buffer.data() + left, p + first + right);
+        }
+        else if (right <= static_cast<int>(buffer.size())) {
+            std::copy(p + middle, p + last, buffer.data());
+            std::copy_backward(p + first, p + middle, p + last);
+            std::copy(buffer.data(), buffer.data() + right, p + first);
+        }
+        else {
+            std::rotate(p + first, p + middle, p + last);
+        }
+        return;
+    }
+    auto reverse = [&](int i, int j) {
+        for (--j; i < j; ++i, --j) {
+            std::swap(a[i], a[j]);
+            probe.step(a, i, j);
+        }
+    };
+    reverse(first, middle);
+    reverse(middle, last);
+    reverse(first, last);
+}
+
+// Merges a[left, mid) with a[mid, right) when the shorter run fits in the buffer: it is copied
+// out and merged back in from its own end of the range, so nothing is overwritten unread.
+template <typename Probe>
+void bufferedMerge(std::vector<int>& a, std::vector<int>& buffer, int left, int mid, int right, Probe& probe) {
+    probe.mark(SortMark::MergeBegin, left, mid, right);
+    if (mid - left <= right - mid) {
+        const int size = mid - left;
+        std::copy(a.begin() + left, a.begin() + mid, buffer.begin());
+        int i = 0, j = mid, k = left;
+        while (i < size && j < right) {
+            probe.compare(j, -1);
+            a[k] = a[j] < buffer[i] ? a[j++] : buffer[i++];
+            probe.step(a, k++);
+        }
+        while (i < size) {
+            a[k] = buffer[i++];
+            probe.step(a, k++);
+        }
+    }
+    else {
+        std::copy(a.begin() + mid, a.begin() + right, buffer.begin());
+        int i = mid - 1, j = right - mid - 1, k = right - 1;
+        while (i >= left && j >= 0) {
+            probe.compare(i, -1);
+            a[k] = buffer[j] < a[i] ? a[i--] : buffer[j--];
+            probe.step(a, k--);
+        }
+        while (j >= 0) {
+            a[k] = buffer[j--];
+            probe.step(a, k--);
+        }
+    }
+    probe.mark(SortMark::MergeEnd, left, right);
+}
+
+// Stable merge of a[left, mid) and a[mid, right) with a buffer of any size, even none. While the
+// shorter run does not fit, the longer one is cut in half, the matching cut in the other run is
+// found by binary search, and the two inner blocks are rotated past each other, which leaves two
+// independent, smaller merges (the recursion of std::inplace_merge when it gets no memory).
+template <typename Probe>
+void blockMerge(std::vector<int>& a, std::vector<int>& buffer, int left, int mid, int right, Probe& probe) {
+    while (left < mid && mid < right) {
+        probe.compare(mid - 1, mid);
+        if (!(a[mid] < a[mid - 1])) return;
+        const int len1 = mid - left, len2 = right - mid;
+        if (std::min(len1, len2) <= static_cast<int>(buffer.size())) {
+            bufferedMerge(a, buffer, left, mid, right, probe);
+            return;
+        }
+
+        int cut1, cut2;
+        if (len1 >= len2) {
+            // keys of the right run below a[cut1] have to move in front of it
+            cut1 = left + len1 / 2;
+            int lo = mid, hi = right;
+            while (lo < hi) {
+                const int m = lo + (hi - lo) / 2;
+                probe.compare(m, cut1);
+                if (a[m] < a[cut1]) lo = m + 1;
+                else hi = m;
+            }
+            cut2 = lo;
+        }
+        else {
+            // keys of the left run up to a[cut2] stay in front of it, which keeps the merge stable
+            cut2 = mid + len2 / 2;
+            int lo = left, hi = mid;
+            while (lo < hi) {
+                const int m = lo + (hi - lo) / 2;
+                probe.compare(cut2, m);
+                if (a[cut2] < a[m]) hi = m;
+                else lo = m + 1;
+            }
+            cut1 = lo;
+        }
+        rotateBlocks(a, buffer, cut1, mid, cut2, probe);
+
+        // the smaller merge recurses and the larger one loops, so the stack stays O(log n)
+        const int newMid = cut1 + (cut2 - mid);
+        if (newMid - left < right - newMid) {
+            blockMerge(a, buffer, left, cut1, newMid, probe);
+            left = newMid;
+            mid = cut2;
+        }
+        else {
+            blockMerge(a, buffer, newMid, cut2, right, probe);
+            right = newMid;
+            mid = cut1;
+        }
+    }
+}
+
+// Stable merge sort without the n-element merge buffer: insertion-sorted runs of 16, then bottom-up
+// block merges with a buffer of sqrt(n) elements (or 'bufferSize', 0 for none at all). Comparisons
+// stay O(n log n); the rotations add moves, up to O(n log^2 n) as the buffer shrinks to nothing.
+template <typename Probe>
+void blockMergeSort(std::vector<int>& a, Probe& probe, int bufferSize = -1) {
+    const int n = static_cast<int>(a.size());
+    if (bufferSize < 0) {
+        bufferSize = 0;
+        while (static_cast<long long>(bufferSize + 1) * (bufferSize + 1) <= n) ++bufferSize;
+    }
+    std::vector<int> buffer(bufferSize);
+    const int runSize = 16;
+    insertionSortRuns(a, runSize, probe);
+    for (long long width = runSize; width < n; width *= 2) {
+        for (long long left = 0; left + width < n; left += 2 * width) {
+            blockMerge(a, buffer, static_cast<int>(left), static_cast<int>(left + width),
+                       static_cast<int>(std::min(left + 2 * width, static_cast<long long>(n))), probe);
+        }
+    }
+}
+
+// Splits a into the runs it already has and returns their bounds, 0 first and n last: maximal
+// non-descending runs, and non-ascending ones reversed in place, after which each group of equal
+// keys is reversed back so they keep their order. A run shorter than minRun is extended to it by
+// insertion sort, so random input does not start from runs of two.
+template <typename Probe>
+std::vector<int> naturalRuns(std::vector<int>& a, int minRun, Probe& probe) {
+    const int n = static_cast<int>(a.size());
+    std::vector<int> bounds{ 0 };
+    for (int start = 0; start < n;) {
+        int end = start + 1;
+        bool descending = false;
+        if (end < n) {
+            probe.compare(start, end);
+            descending = a[end] < a[start];
+            for (++end; end < n; ++end) {
+                probe.compare(end - 1, end);
+                if (descending ? a[end - 1] < a[end] : a[end] < a[end - 1]) break;
+            }
+        }
+        probe.mark(SortMark::NaturalRun, start, end, descending ? 1 : 0);
+        if (descending) {
+            auto reverse = [&](int i, int j) {
+                for (--j; i < j; ++i, --j) {
+                    std::swap(a[i], a[j]);
+                    probe.step(a, i, j);
+                }
+            };
+            reverse(start, end);
+            for (int i = start; i < end;) {
+                int j = i + 1;
+                for (; j < end; ++j) {
+                    probe.compare(i, j);
+                    if (a[i] < a[j]) break;
+                }
+                reverse(i, j);
+                i = j;
+            }
+        }
+        if (end - start < minRun && end < n) {
+            const int target = std::min(start + minRun, n);
+            probe.mark(SortMark::Run, start, target);
+            for (; end < target; ++end) insertIntoRun(a, start, end, probe);
+        }
+        bounds.push_back(end);
+        start = end;
+    }
+    return bounds;
+}
+
+// Narrows the merge of p[left, mid) and p[mid, right), with p[mid] < p[mid - 1], to the part that
+// interleaves: the left run's keys up to p[mid] and the right run's keys from p[mid - 1] on are
+// already in place.
+template <typename Probe>
+void trimMerge(const int* p, int& left, int mid, int& right, Probe& probe) {
+    int lo = left, hi = mid;
+    while (lo < hi) {
+        const int m = lo + (hi - lo) / 2;
+        probe.compare(mid, m);
+        if (p[mid] < p[m]) hi = m;
+        else lo = m + 1;
+    }
+    left = lo;
+    lo = mid;
+    hi = right;
+    while (lo < hi) {
+        const int m = lo + (hi - lo) / 2;
+        probe.compare(m, mid - 1);
+        if (p[m] < p[mid - 1]) lo = m + 1;
+        else hi = m;
+    }
+    right = lo;
+}
+
+// The end of the prefix of the sorted p[lo, hi) that goes before p[key]: keys up to it when
+// 'upper', keys below it otherwise. Probes lo, lo + 1, lo + 3, lo + 7, ... and then binary-searches
+// the last gap, so a prefix of length d costs about 2 log2 d comparisons.
+template <typename Probe>
+int gallop(const int* p, int lo, int hi, int key, bool upper, Probe& probe) {
+    auto goesFirst = [&](int m) {
+        probe.compare(m, key);
+        return upper ? !(p[key] < p[m]) : p[m] < p[key];
+    };
+    int found = lo, step = 1;
+    while (lo + step - 1 < hi && goesFirst(lo + step - 1)) {
+        found = lo + step;
+        step *= 2;
+    }
+    int end = std::min(lo + step - 1, hi);
+    while (found < end) {
+        const int m = found + (end - found) / 2;
+        if (goesFirst(m)) found = m + 1;
+        else end = m;
+    }
+    return found;
+}
+
+// Stable merge of from[left, mid) and from[mid, right) into to[left, right). Once one run has won
+// kMinGallop times in a row it gallops to the other run's head and copies the stretch in one go,
+// as Timsort does, so runs that barely interleave (a few outliers each) cost O(log) comparisons per
+// switch instead of one per element.
+template <typename Probe>
+void gallopMerge(const int* from, int* to, int left, int mid, int right, Probe& probe) {
+    const int kMinGallop = 7;
+    int i = left, j = mid, k = left;
+    int leftWins = 0, rightWins = 0;
+    while (i < mid && j < right) {
+        if (leftWins >= kMinGallop) {
+            const int end = gallop(from, i, mid, j, true, probe);
+            k = static_cast<int>(std::copy(from + i, from + end, to + k) - to);
+            i = end;
+            leftWins = 0;
+        }
+        else if (rightWins >= kMinGallop) {
+            const int end = gallop(from, j, right, i, false, probe);
+            k = static_cast<int>(std::copy(from + j, from + end, to + k) - to);
+            j = end;
+            rightWins = 0;
+        }
+        else {
+            probe.compare(j, i);
+            if (from[j] < from[i]) {
+                to[k++] = from[j++];
+                ++rightWins;
+                leftWins = 0;
+            }
+            else {
+                to[k++] = from[i++];
+                ++leftWins;
+                rightWins = 0;
+            }
+        }
+    }
+    to = std::copy(from + i, from + mid, to + k);
+    std::copy(from + j, from + right, to);
+}
+
+// One merge of an untraced natural merge pass, from one array into the other: runs already in order
+// are copied as they are, and the keys trimMerge finds in place are copied around the merge.
+inline void mergeInto(const int* from, int* to, int left, int mid, int right) {
+    NullTracer none;
+    if (mid == right || !(from[mid] < from[mid - 1])) {
+        std::copy(from + left, from + right, to + left);
+        return;
+    }
+    int first = left, last = right;
+    trimMerge(from, first, mid, last, none);
+    std::copy(from + left, from + first, to + left);
+    std::copy(from + last, from + right, to + last);
+    gallopMerge(from, to, first, mid, last, none);
+}
+
+// Natural merge sort: the runs the input already has, then bottom-up passes that merge neighbouring
+// runs in pairs, so sorted input costs n - 1 comparisons and r runs take ceil(log2 r) passes
+// instead of log2 n. Each merge skips the keys already in place and gallops over long stretches.
+// Untraced, a pass merges from one array into the other and nothing is copied back (the arrays
+// trade places at the end when the pass count is odd); traced, each merge is copied back into the
+// visible array.
+template <typename Probe>
+void naturalMergeSort(std::vector<int>& a, Probe& probe) {
+    const int minRun = 16;
+    std::vector<int> bounds = naturalRuns(a, minRun, probe);
+    if (bounds.size() <= 2) return;
+    std::vector<int> buffer(a.size());
+
+    if constexpr (!Probe::records) {
+        int* from = a.data();
+        int* to = buffer.data();
+        while (bounds.size() > 2) {
+            size_t kept = 1;
+            for (size_t r = 0; r + 1 < bounds.size(); r += 2) {
+                // an odd run out at the end is copied over as it is
+                const int right = bounds[std::min(r + 2, bounds.size() - 1)];
+                mergeInto(from, to, bounds[r], bounds[r + 1], right);
+                bounds[kept++] = right;
+            }
+            bounds.resize(kept);
+            std::swap(from, to);
+        }
+        if (from != a.data()) a.swap(buffer);
+        return;
+    }
+    while (bounds.size() > 2) {
+        probe.mark(SortMark::MergePass, static_cast<int>(bounds.size()) - 1);
+        size_t kept = 1;
+        for (size_t r = 0; r + 1 < bounds.size(); r += 2) {
+            const int mid = bounds[r + 1];
+            const int right = bounds[std::min(r + 2, bounds.size() - 1)];
+            if (mid < right) {
+                probe.compare(mid - 1, mid);
+                if (a[mid] < a[mid - 1]) {
+                    int first = bounds[r], last = right;
+                    trimMerge(a.data(), first, mid, last, probe);
+                    probe.mark(SortMark::MergeBegin, first, mid, last);
+                    gallopMerge(a.data(), buffer.data(), first, mid, last, probe);
+                    for (int k = first; k < last; ++k) {
+                        a[k] = buffer[k];
+                        probe.step(a, k);
+                    }
+                    probe.mark(SortMark::MergeEnd, first, last);
+                }
+            }
+            bounds[kept++] = right;
+        }
+        bounds.resize(kept);
+    }
+}
+
+// LSD radix sort, base 10. Values are shifted by the minimum so negatives work too.
+template <typename Probe>
+void radixSort(std::vector<int>& a, Probe& probe, const SortOptions& options = {}) {
+    if (a.empty()) return;
+    const int n = static_cast<int>(a.size());
+    // every digit pass costs a full scan plus ten buckets, which a tiny input never earns back
+    if (n < options.cutoff) {
+        sortSmallRange(a, 0, n, options.smallSort, probe);
+        return;
+    }
+    auto [minIt, maxIt] = std::minmax_element(a.begin(), a.end());
+    const long long minValue = *minIt;
+    const long long range = static_cast<long long>(*maxIt) - minValue;
+
+    std::vector<int> bucket(a.size());
+    for (long long digitPlace = 1; range / digitPlace > 0; digitPlace *= 10) {
+        probe.mark(SortMark::DigitPass, static_cast<int>(digitPlace));
+        int count[10] = { 0 };
+        for (int k = 0; k < n; ++k) {
+            int digit = static_cast<int>(((a[k] - minValue) / digitPlace) % 10);
+            probe.mark(SortMark::CountDigit, k, digit);
+            count[digit]++;
+        }
+        for (int d = 1; d < 10; ++d) {
+            count[d] += count[d - 1];
+            probe.mark(SortMark::Accumulate, d);
+        }
+        for (int k = n - 1; k >= 0; --k) {
+            int slot = --count[((a[k] - minValue) / digitPlace) % 10];
+            bucket[slot] = a[k];
+            probe.mark(SortMark::Place, k, slot);
+        }
+        for (int k = 0; k < n; ++k) {
+            a[k] = bucket[k];
+            probe.step(a, k);
+        }
+    }
+}
+
+template <typename Probe>
+void gnomeSort(std::vector<int>& a, Probe& probe) {
+    const int n = static_cast<int>(a.size());
+    int index = 0;
+    while (index < n) {
+        if (index == 0) {
+            ++index;
+            continue;
+        }
+        probe.compare(index, index - 1);
+        if (a[index] >= a[index - 1]) {
+            ++index;
+        }
+        else {
+            std::swap(a[index], a[index - 1]);
+            probe.step(a, index, index - 1);
+            --index;
+        }
+    }
+}
+
+// Yaroslavskiy's dual-pivot quick sort, as in the JDK: one pass splits a range into < p, between
+// and > q, so each level does a third of the work of two single-pivot levels for about the same
+// comparisons, and the recursion is log3 n deep instead of log2 n. When the middle part is large,
+// a second pass gathers the keys equal to a pivot next to it, where they are final, so few distinct
+// keys cannot make it quadratic.
+template <typename Probe>
+void dualPivotQuickSort(std::vector<int>& a, Probe& probe, const SortOptions& options = {}) {
+    std::vector<std::pair<int, int>> stack;
+    PivotRng rng;
+    if (!a.empty()) stack.push_back({ 0, static_cast<int>(a.size()) - 1 });
+
+    while (!stack.empty()) {
+        auto [left, right] = stack.back();
+        stack.pop_back();
+        if (left >= right) {
+            if (left == right) probe.mark(SortMark::Sorted, left, left + 1);
+            continue;
+        }
+        if (right - left + 1 < options.cutoff) {
+            sortSmallRange(a, left, right + 1, options.smallSort, probe);
+            probe.mark(SortMark::Sorted, left, right + 1);
+            continue;
+        }
+
+        placeDualPivots(a, left, right, options.pivot, rng, probe);
+        probe.mark(SortMark::DualPartition, left, right);
+        const int p = a[left], q = a[right];
+        int lt = left + 1, k = left + 1, gt = right - 1;
+        while (k <= gt) {
+            probe.mark(SortMark::DualRegions, lt, k, gt);
+            probe.compare(k, left);
+            if (a[k] < p) {
+                std::swap(a[k], a[lt]);
+                probe.step(a, lt, k);
+                ++lt;
+            }
+            else {
+                probe.compare(k, right);
+                if (a[k] > q) {
+                    while (k < gt) {
+                        probe.compare(gt, right);
+                        if (!(a[gt] > q)) break;
+                        --gt;
+                    }
+                    std::swap(a[k], a[gt]);
+                    probe.step(a, gt, k);
+                    --gt;
+                    probe.compare(k, left);
+                    if (a[k] < p) {
+                        std::swap(a[k], a[lt]);
+                        probe.step(a, lt, k);
+                        ++lt;
+                    }
+                }
+            }
+            ++k;
+        }
+        --lt;
+        ++gt;
+        std::swap(a[left], a[lt]);
+        probe.step(a, left, lt);
+        std::swap(a[right], a[gt]);
+        probe.step(a, right, gt);
+        probe.mark(SortMark::PivotPlaced, lt);
+        probe.mark(SortMark::PivotPlaced, gt);
+
+        int low = lt + 1, high = gt - 1;
+        if (p == q) {
+            // every key between equal pivots equals them
+            if (low <= high) probe.mark(SortMark::EqualRange, low, high + 1);
+            low = high + 1;
+        }
+        else if (high - low > (right - left) * 4 / 7) {
+            // the same three-way loop with == for < and >, between the placed pivots
+            probe.mark(SortMark::DualPartition, lt, gt, 1);
+            int first = low, last = high;
+            for (k = low; k <= last; ++k) {
+                probe.mark(SortMark::DualRegions, first, k, last);
+                probe.compare(k, lt);
+                if (a[k] == p) {
+                    std::swap(a[k], a[first]);
+                    probe.step(a, first, k);
+                    ++first;
+                    continue;
+                }
+                probe.compare(k, gt);
+                if (a[k] != q) continue;
+                while (k < last) {
+                    probe.compare(last, gt);
+                    if (a[last] != q) break;
+                    --last;
+                }
+                std::swap(a[k], a[last]);
+                probe.step(a, last, k);
+                --last;
+                probe.compare(k, lt);
+                if (a[k] == p) {
+                    std::swap(a[k], a[first]);
+                    probe.step(a, first, k);
+                    ++first;
+                }
+            }
+            probe.mark(SortMark::EqualRange, low, first);
+            probe.mark(SortMark::EqualRange, last + 1, high + 1);
+            low = first;
+            high = last;
+        }
+        pushSides(stack, { left, lt - 1 }, { low, high }, { gt + 1, right }, probe);
+    }
+}
+
+// Sorting network for the whole input, layer by layer: compiled in and unrolled up to
+// kMaxFixedNetwork elements, Batcher's merge exchange (O(n log^2 n) comparators) beyond.
+template <typename Probe>
+void networkSort(std::vector<int>& a, Probe& probe) {
+    const int n = static_cast<int>(a.size());
+    if constexpr (!Probe::records) {
+        // nothing to report, so large networks are streamed instead of listed by layer
+        if (n <= kMaxFixedNetwork) {
+            networkKernels[n](a.data());
+        }
+        else {
+            NetworkDetail::forEachComparator(n, [&a](int i, int j) {
+                const int x = a[i], y = a[j];
+                a[i] = y < x ? y : x;
+                a[j] = y < x ? x : y;
+            });
+        }
+        return;
+    }
+
+    int depth = 0;
+    const std::vector<NetworkComparator> network = sortingNetwork(n, &depth);
+    int layer = -1;
+    for (const NetworkComparator& c : network) {
+        if (c.layer != layer) {
+            layer = c.layer;
+            probe.mark(SortMark::NetworkLayer, layer, depth);
+        }
+        probe.compare(c.a, c.b);
+        const int x = a[c.a], y = a[c.b];
+        a[c.a] = y < x ? y : x;
+        a[c.b] = y < x ? x : y;
+        if (y < x) probe.step(a, c.a, c.b);
+    }
+}
+
+// Bitonic sort in the variant without descending blocks: a block of k is merged by first pairing
+// every element with its mirror, then by half cleaners at k/4, k/8, ..., 1, and every
+// compare-exchange puts the smaller value first. Elements past n act as +infinity padding, so
+// those pairs are no-ops and any n works. Untraced, it is the parallel SIMD version.
+template <typename Probe>
+void bitonicSort(std::vector<int>& a, Probe& probe) {
+    if constexpr (!Probe::records) {
+        parallelBitonicSort(a);
+        return;
+    }
+
+    const int n = static_cast<int>(a.size());
+    for (long long k = 2; k / 2 < n; k *= 2) {
+        for (long long d = k / 2; d > 0; d /= 2) {
+            const bool mirrored = d == k / 2;
+            probe.mark(SortMark::BitonicStage, static_cast<int>(k), static_cast<int>(d), mirrored ? 1 : 0);
+            for (int i = 0; i < n; ++i) {
+                if (i & d) continue; // i is the upper element of its pair
+                const long long j = mirrored ? (i ^ (k - 1)) : i + d;
+                if (j >= n) continue;
+                probe.compare(i, static_cast<int>(j));
+                if (a[j] < a[i]) {
+                    std::swap(a[i], a[j]);
+                    probe.step(a, i, static_cast<int>(j));
+                }
+            }
+        }
+    }
+}
+
+// Counting sort for a key range small next to n: count every key, then write each key out as
+// often as it occurred. Wider ranges go to radix sort. Untraced, it is denseCountingSort.
+template <typename Probe>
+void countingSort(std::vector<int>& a, Probe& probe, const SortOptions& options = {}) {
+    if (a.empty()) return;
+    const int n = static_cast<int>(a.size());
+    int minValue, maxValue;
+    keyRange(a.data(), n, minValue, maxValue);
+    const long long range = static_cast<long long>(maxValue) - minValue;
+    if (!countingSortApplies(n, range)) {
+        radixSort(a, probe, options);
+        return;
+    }
+    if constexpr (!Probe::records) {
+        denseCountingSort(a, minValue, range);
+        return;
+    }
+
+    std::vector<int> count(range + 1, 0);
+    for (int k = 0; k < n; ++k) {
+        const int key = a[k] - minValue;
+        probe.mark(SortMark::CountDigit, k, key);
+        ++count[key];
+    }
+    int k = 0;
+    for (int key = 0; key <= range; ++key) {
+        for (int c = 0; c < count[key]; ++c, ++k) {
+            a[k] = minValue + key;
+            probe.step(a, k);
+        }
+    }
+}
+
+// One traced bucket pass over a[first, last): scatter by the top bits of the keys, then sort each
+// bucket. Buckets of up to kSimdBlock are insertion-sorted; larger ones, which skewed keys pile up,
+// get another pass over their own, narrower key range (as parallelBucketSort splits them), so a
+// single outlier cannot leave one quadratic insertion sort over almost every key.
+template <typename Probe>
+void bucketPass(std::vector<int>& a, int first, int last, Probe& probe) {
+    const int n = last - first;
+    int minValue, maxValue;
+    keyRange(a.data() + first, n, minValue, maxValue);
+    if (minValue == maxValue) return;
+    const int buckets = bucketCount(n);
+    const int shift = bucketShift(static_cast<long long>(maxValue) - minValue, buckets);
+
+    std::vector<int> start(buckets + 1, 0);
+    for (int k = first; k < last; ++k) {
+        const int b = bucketOf(a[k], minValue, shift);
+        probe.mark(SortMark::CountDigit, k, b);
+        ++start[b + 1];
+    }
+    start[0] = first;
+    for (int b = 1; b <= buckets; ++b) {
+        start[b] += start[b - 1];
+        probe.mark(SortMark::Accumulate, b - 1);
+    }
+    std::vector<int> next(start.begin(), start.end() - 1);
+    std::vector<int> scattered(n);
+    for (int k = first; k < last; ++k) {
+        const int slot = next[bucketOf(a[k], minValue, shift)]++;
+        scattered[slot - first] = a[k];
+        probe.mark(SortMark::Place, k, slot);
+    }
+    for (int k = first; k < last; ++k) {
+        a[k] = scattered[k - first];
+        probe.step(a, k);
+    }
+
+    // a shift of 0 gives every key its own bucket, and those need no sorting
+    if (shift == 0) return;
+    for (int b = 0; b < buckets; ++b) {
+        if (start[b + 1] - start[b] < 2) continue;
+        if (start[b + 1] - start[b] > kSimdBlock) {
+            bucketPass(a, start[b], start[b + 1], probe);
+            continue;
+        }
+        probe.mark(SortMark::Run, start[b], start[b + 1]);
+        for (int i = start[b] + 1; i < start[b + 1]; ++i) insertIntoRun(a, start[b], i, probe);
+    }
+}
+
+// Bucket sort: a stable scatter into buckets of about 16 keys each by their top bits, then each
+// bucket is sorted by bucketPass. Untraced, it is parallelBucketSort.
+template <typename Probe>
+void bucketSort(std::vector<int>& a, Probe& probe) {
+    if constexpr (!Probe::records) {
+        parallelBucketSort(a);
+        return;
+    }
+    if (a.size() < 2) return;
+    bucketPass(a, 0, static_cast<int>(a.size()), probe);
+}
+
+template <typename Probe>
+void run(SortAlgorithm alg, std::vector<int>& a, Probe& probe, const SortOptions& options = {}) {
+    switch (alg) {
+    case SortAlgorithm::Bubble:    bubbleSort(a, probe); break;
+    case SortAlgorithm::Insertion: insertionSort(a, probe); break;
+    case SortAlgorithm::Selection: selectionSort(a, probe); break;
+    case SortAlgorithm::Quick:     quickSort(a, probe, options); break;
+    case SortAlgorithm::Quick3:    quickSort3(a, probe, options); break;
+    case SortAlgorithm::Merge:     mergeSort(a, probe, options); break;
+    case SortAlgorithm::Heap:      heapSort(a, probe, options); break;
+    case SortAlgorithm::Shell:     shellSort(a, probe, options); break;
+    case SortAlgorithm::Tim:       timSort(a, probe); break;
+    case SortAlgorithm::Radix:     radixSort(a, probe, options); break;
+    case SortAlgorithm::Gnome:     gnomeSort(a, probe); break;
+    case SortAlgorithm::Network:   networkSort(a, probe); break;
+    case SortAlgorithm::Bitonic:   bitonicSort(a, probe); break;
+    case SortAlgorithm::Counting:  countingSort(a, probe, options); break;
+    case SortAlgorithm::Bucket:    bucketSort(a, probe); break;
+    case SortAlgorithm::DualPivot: dualPivotQuickSort(a, probe, options); break;
+    case SortAlgorithm::BlockMerge: blockMergeSort(a, probe); break;
+    case SortAlgorithm::NaturalMerge: naturalMergeSort(a, probe); break;
+    }
+    probe.mark(SortMark::Sorted, 0, static_cast<int>(a.size()));
+}
+
+} // namespace SortEngine
+
+#endif // SORTENGINE_H
@@ -0,0 +1,41 @@
+#include "sortnetwork.h"
+
+namespace SortEngine {
+
+namespace {
+
+struct FixedView {
+    const NetworkComparator* comparators;
+    int size;
+    int depth;
+};
+
+template <std::size_t... N>
+constexpr std::array<FixedView, sizeof...(N)> fixedViews(std::index_sequence<N...>) {
+    return { FixedView{ FixedNetwork<N>::network.comparators.data(), FixedNetwork<N>::size, FixedNetwork<N>::network.depth }... };
+}
+
+// the compile-time networks, indexed by size
+constexpr std::array<FixedView, kMaxFixedNetwork + 1> kFixed = fixedViews(std::make_index_sequence<kMaxFixedNetwork + 1>{});
+
+} // namespace
+
+std::vector<NetworkComparator> sortingNetwork(int n, int* depth) {
+    int layers = 0;
+    std::vector<NetworkComparator> list;
+    if (n <= kMaxFixedNetwork) {
+        const FixedView& fixed = kFixed[n];
+        list.assign(fixed.comparators, fixed.comparators + fixed.size);
+        layers = fixed.depth;
+    }
+    else {
+        list.reserve(NetworkDetail::comparatorCount(n));
+        NetworkDetail::forEachComparator(n, [&list](int a, int b) { list.push_back({ a, b, 0 }); });
+        std::vector<int> last(n, 0);
+        layers = NetworkDetail::layerComparators(list, static_cast<int>(list.size()), last);
+    }
+    if (depth) *depth = layers;
+    return list;
+}
+
+} // namespace SortEngine
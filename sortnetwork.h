@@ -0,0 +1,153 @@
+#ifndef SORTNETWORK_H
+#define SORTNETWORK_H
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/*
+ * Sorting networks: a fixed list of compare-exchanges that sorts any input of one size, so the
+ * work does not depend on the data and every compare-exchange is a min and a max without a branch.
+ *
+ * Networks for 2..8 elements are the size-optimal ones (Knuth, TAOCP 5.3.4); larger sizes use
+ * Batcher's merge exchange (Algorithm 5.2.2M), which works for any n. Up to kMaxFixedNetwork the
+ * comparator lists are built at compile time and every size gets a fully unrolled kernel.
+ */
+
+namespace SortEngine {
+
+constexpr int kMaxFixedNetwork = 32;
+
+struct NetworkComparator {
+    int a = 0, b = 0; // a < b: the smaller value ends up at a
+    int layer = 0;    // comparators of one layer touch disjoint elements and could run at once
+};
+
+namespace NetworkDetail {
+
+// size-optimal networks; those of size n are the pairs [kOptimalStart[n], kOptimalStart[n + 1])
+constexpr int kOptimalPairs[][2] = {
+    {0, 1},
+    {0, 2}, {0, 1}, {1, 2},
+    {0, 2}, {1, 3}, {0, 1}, {2, 3}, {1, 2},
+    {0, 3}, {1, 4}, {0, 2}, {1, 3}, {0, 1}, {2, 4}, {1, 2}, {3, 4}, {2, 3},
+    {0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3}, {2, 5}, {0, 1}, {2, 3}, {4, 5}, {1, 2}, {3, 4},
+    {0, 6}, {2, 3}, {4, 5}, {0, 2}, {1, 4}, {3, 6}, {0, 1}, {2, 5}, {3, 4}, {1, 2}, {4, 6}, {2, 3}, {4, 5},
+    {1, 2}, {3, 4}, {5, 6},
+    {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}, {0, 1}, {2, 3}, {4, 5}, {6, 7},
+    {2, 4}, {3, 5}, {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}
+};
+constexpr int kOptimalStart[] = { 0, 0, 0, 1, 4, 9, 18, 30, 46, 65 };
+
+// Calls emit(a, b) for every comparator of the network for n elements, in a valid order.
+template <typename Emit>
+constexpr void forEachComparator(int n, Emit&& emit) {
+    if (n <= 8) {
+        for (int k = kOptimalStart[n]; k < kOptimalStart[n + 1]; ++k)
+            emit(kOptimalPairs[k][0], kOptimalPairs[k][1]);
+        return;
+    }
+    int t = 0;
+    while ((1 << t) < n) ++t;
+    for (int p = 1 << (t - 1); p > 0; p >>= 1) {
+        int q = 1 << (t - 1), r = 0, d = p;
+        while (true) {
+            for (int i = 0; i < n - d; ++i) {
+                if ((i & p) == r) emit(i, i + d);
+            }
+            if (q == p) break;
+            d = q - p;
+            q >>= 1;
+            r = p;
+        }
+    }
+}
+
+constexpr int comparatorCount(int n) {
+    int count = 0;
+    forEachComparator(n, [&count](int, int) { ++count; });
+    return count;
+}
+
+// Assigns every comparator the first layer after those of its two elements, then orders the list
+// by layer (stably, so dependencies keep their order). 'last' holds one zero per element.
+template <typename List, typename Last>
+constexpr int layerComparators(List& list, int count, Last& last) {
+    int depth = 0;
+    for (int k = 0; k < count; ++k) {
+        int layer = last[list[k].a] > last[list[k].b] ? last[list[k].a] : last[list[k].b];
+        list[k].layer = layer;
+        last[list[k].a] = last[list[k].b] = layer + 1;
+        if (layer + 1 > depth) depth = layer + 1;
+    }
+    for (int k = 1; k < count; ++k) {
+        NetworkComparator c = list[k];
+        int j = k;
+        for (; j > 0 && list[j - 1].layer > c.layer; --j) list[j] = list[j - 1];
+        list[j] = c;
+    }
+    return depth;
+}
+
+} // namespace NetworkDetail
+
+// The network for N elements, built at compile time.
+template <int N>
+struct FixedNetwork {
+    static constexpr int size = NetworkDetail::comparatorCount(N);
+
+    struct Built {
+        std::array<NetworkComparator, size> comparators{};
+        int depth = 0;
+    };
+    static constexpr Built build() {
+        Built built;
+        int k = 0;
+        NetworkDetail::forEachComparator(N, [&](int a, int b) { built.comparators[k++] = { a, b, 0 }; });
+        int last[N > 0 ? N : 1] = {};
+        built.depth = NetworkDetail::layerComparators(built.comparators, size, last);
+        return built;
+    }
+
+    static constexpr Built network = build();
+};
+
+// Branchless compare-exchange; compilers turn the two selects into min/max or cmov.
+template <int A, int B>
+inline void compareExchange(int* p) {
+    const int x = p[A], y = p[B];
+    p[A] = y < x ? y : x;
+    p[B] = y < x ? x : y;
+}
+
+// 'p' is unused for N < 2, whose networks have no comparators.
+template <int N, std::size_t... I>
+inline void applyFixedNetwork([[maybe_unused]] int* p, std::index_sequence<I...>) {
+    (compareExchange<FixedNetwork<N>::network.comparators[I].a, FixedNetwork<N>::network.comparators[I].b>(p), ...);
+}
+
+// Sorts p[0, N) with the unrolled network.
+template <int N>
+void fixedNetworkSort(int* p) {
+    applyFixedNetwork<N>(p, std::make_index_sequence<FixedNetwork<N>::size>{});
+}
+
+using NetworkKernel = void (*)(int*);
+
+template <std::size_t... N>
+constexpr std::array<NetworkKernel, sizeof...(N)> makeNetworkKernels(std::index_sequence<N...>) {
+    return { &fixedNetworkSort<static_cast<int>(N)>... };
+}
+
+// networkKernels[n] sorts n elements, for n <= kMaxFixedNetwork.
+inline constexpr std::array<NetworkKernel, kMaxFixedNetwork + 1> networkKernels =
+    makeNetworkKernels(std::make_index_sequence<kMaxFixedNetwork + 1>{});
+
+// The comparators for n elements ordered by layer: the compile-time list up to kMaxFixedNetwork,
+// generated on demand for larger n. 'depth' receives the number of layers.
+std::vector<NetworkComparator> sortingNetwork(int n, int* depth = nullptr);
+
+} // namespace SortEngine
+
+#endif // SORTNETWORK_H
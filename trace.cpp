@@ -0,0 +1,399 @@
+#include "trace.h"
+
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const char kMagic[4] = { 'S', 'A', 'T', 'R' };
+const char kTrailerMagic[8] = { 'S', 'A', 'T', 'R', 'E', 'N', 'D', '1' };
+const quint32 kVersion = 1;
+const int kFlushBytes = 1 << 20;
+
+quint64 zigzag(qint64 v) { return (static_cast<quint64>(v) << 1) ^ static_cast<quint64>(v >> 63); }
+qint64 unzigzag(quint64 v) { return static_cast<qint64>(v >> 1) ^ -static_cast<qint64>(v & 1); }
+
+void putVarint(QByteArray& out, quint64 v) {
+    while (v >= 0x80) {
+        out.append(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.append(static_cast<char>(v));
+}
+
+void putSigned(QByteArray& out, qint64 v) { putVarint(out, zigzag(v)); }
+
+void putString(QByteArray& out, const QString& s) {
+    QByteArray utf8 = s.toUtf8();
+    putVarint(out, static_cast<quint64>(utf8.size()));
+    out.append(utf8);
+}
+
+void putU64(QByteArray& out, quint64 v) {
+    char bytes[8];
+    qToLittleEndian(v, bytes);
+    out.append(bytes, 8);
+}
+
+// Bounds-checked reading from the mapped file; any overrun clears 'ok'.
+struct Cursor {
+    const uchar* p;
+    const uchar* end;
+    bool ok = true;
+
+    quint64 varint() {
+        quint64 v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) break;
+            uchar b = *p++;
+            v |= static_cast<quint64>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+    qint64 signedVarint() { return unzigzag(varint()); }
+    QString string() {
+        quint64 len = varint();
+        if (!ok || len > static_cast<quint64>(end - p)) {
+            ok = false;
+            return QString();
+        }
+        QString s = QString::fromUtf8(reinterpret_cast<const char*>(p), static_cast<int>(len));
+        p += len;
+        return s;
+    }
+    uchar byte() {
+        if (p >= end) {
+            ok = false;
+            return 0;
+        }
+        return *p++;
+    }
+};
+
+quint64 readU64(const uchar* p) { return qFromLittleEndian<quint64>(p); }
+}
+
+// ---------------------------------------------------------------- writer
+
+TraceWriter::~TraceWriter() {
+    if (file.isOpen()) file.close();
+}
+
+bool TraceWriter::open(const QString& path, const TraceHeader& header) {
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = file.errorString();
+        return false;
+    }
+
+    current = header.input;
+    currentExtras.assign(header.extraNames.size(), 0);
+    sorted.clear();
+    keyframeOffsets.clear();
+    frameCount = 0;
+    flushed = 0;
+    buffer.clear();
+
+    // a keyframe costs about as much as n frames, so keep them roughly proportional
+    keyframeInterval = std::max(256, static_cast<int>(current.size()));
+
+    buffer.append(kMagic, 4);
+    char version[4];
+    qToLittleEndian(kVersion, version);
+    buffer.append(version, 4);
+
+    putString(buffer, header.algorithm);
+    putVarint(buffer, current.size());
+    qint64 prev = 0;
+    for (int v : current) {
+        putSigned(buffer, v - prev);
+        prev = v;
+    }
+    putVarint(buffer, static_cast<quint64>(header.extraNames.size()));
+    for (const QString& name : header.extraNames) putString(buffer, name);
+    putVarint(buffer, static_cast<quint64>(header.metadata.size()));
+    for (const auto& kv : header.metadata) {
+        putString(buffer, kv.first);
+        putString(buffer, kv.second);
+    }
+    putVarint(buffer, static_cast<quint64>(keyframeInterval));
+    return true;
+}
+
+void TraceWriter::writeKeyframe() {
+    keyframeOffsets.push_back(static_cast<quint64>(flushed + buffer.size()));
+    buffer.append('K');
+
+    qint64 prev = 0;
+    for (int v : current) {
+        putSigned(buffer, v - prev);
+        prev = v;
+    }
+
+    // sorted indices as [start, length) intervals, starts gap-coded
+    QByteArray intervals;
+    int intervalCount = 0;
+    int n = static_cast<int>(current.size());
+    int lastEnd = 0;
+    for (int k = 0; k < n;) {
+        if (!sorted.contains(k)) {
+            ++k;
+            continue;
+        }
+        int start = k;
+        while (k < n && sorted.contains(k)) ++k;
+        putVarint(intervals, static_cast<quint64>(start - lastEnd));
+        putVarint(intervals, static_cast<quint64>(k - start));
+        lastEnd = k;
+        ++intervalCount;
+    }
+    putVarint(buffer, static_cast<quint64>(intervalCount));
+    buffer.append(intervals);
+
+    for (int e : currentExtras) putSigned(buffer, e);
+}
+
+void TraceWriter::addFrame(const std::vector<int>& array, int i, int j, int pivot,
+                           const std::vector<int>& newlySorted, const std::vector<int>& extras) {
+    if (array.size() != current.size()) current.resize(array.size(), 0);
+    std::vector<int> changed;
+    for (int k = 0; k < static_cast<int>(array.size()); ++k) {
+        if (array[k] != current[k]) changed.push_back(k);
+    }
+    addFrame(array, changed, i, j, pivot, newlySorted, extras);
+}
+
+void TraceWriter::addFrame(const std::vector<int>& array, const std::vector<int>& changed, int i, int j, int pivot,
+                           const std::vector<int>& newlySorted, const std::vector<int>& extras) {
+    if (frameCount % static_cast<quint64>(keyframeInterval) == 0) writeKeyframe();
+    buffer.append('F');
+
+    // changed elements: index gap, value delta
+    if (array.size() != current.size()) current.resize(array.size(), 0);
+    written.assign(changed.begin(), changed.end());
+    std::sort(written.begin(), written.end());
+    QByteArray changes;
+    int changeCount = 0;
+    int lastIndex = -1;
+    for (int k : written) {
+        if (k <= lastIndex || array[k] == current[k]) continue;
+        putVarint(changes, static_cast<quint64>(k - lastIndex - 1));
+        putSigned(changes, static_cast<qint64>(array[k]) - current[k]);
+        current[k] = array[k];
+        lastIndex = k;
+        ++changeCount;
+    }
+    putVarint(buffer, static_cast<quint64>(changeCount));
+    buffer.append(changes);
+
+    putVarint(buffer, static_cast<quint64>(i + 1));
+    putVarint(buffer, static_cast<quint64>(j + 1));
+    putVarint(buffer, static_cast<quint64>(pivot + 1));
+
+    std::vector<int> settled(newlySorted);
+    std::sort(settled.begin(), settled.end());
+    putVarint(buffer, settled.size());
+    lastIndex = -1;
+    for (int k : settled) {
+        putVarint(buffer, static_cast<quint64>(k - lastIndex - 1));
+        sorted.insert(k);
+        lastIndex = k;
+    }
+
+    for (size_t e = 0; e < currentExtras.size(); ++e) {
+        int v = e < extras.size() ? extras[e] : 0;
+        putSigned(buffer, static_cast<qint64>(v) - currentExtras[e]);
+        currentExtras[e] = v;
+    }
+
+    ++frameCount;
+    if (buffer.size() >= kFlushBytes) flush();
+}
+
+void TraceWriter::flush() {
+    if (buffer.isEmpty()) return;
+    if (file.write(buffer) != buffer.size() && error.isEmpty()) error = file.errorString();
+    flushed += buffer.size();
+    buffer.clear();
+}
+
+bool TraceWriter::finish() {
+    quint64 footerOffset = static_cast<quint64>(flushed + buffer.size());
+    putU64(buffer, frameCount);
+    putU64(buffer, keyframeOffsets.size());
+    for (quint64 offset : keyframeOffsets) {
+        putU64(buffer, offset);
+        if (buffer.size() >= kFlushBytes) flush();
+    }
+    putU64(buffer, footerOffset);
+    buffer.append(kTrailerMagic, 8);
+    flush();
+    file.close();
+    return error.isEmpty();
+}
+
+// ---------------------------------------------------------------- reader
+
+bool TraceReader::open(const QString& path) {
+    close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    size = file.size();
+    data = file.map(0, size);
+    if (!data) {
+        fallback = file.readAll();
+        data = reinterpret_cast<const uchar*>(fallback.constData());
+    }
+
+    auto fail = [this](const QString& why) {
+        close();
+        error = why;
+        return false;
+    };
+
+    if (size < 8 + 16 || memcmp(data, kMagic, 4) != 0 || memcmp(data + size - 8, kTrailerMagic, 8) != 0)
+        return fail("Not a trace file.");
+    if (qFromLittleEndian<quint32>(data + 4) != kVersion)
+        return fail("Unsupported trace version.");
+
+    Cursor c{ data + 8, data + size };
+    head.algorithm = c.string();
+    quint64 n = c.varint();
+    if (!c.ok || n > static_cast<quint64>(size)) return fail("Corrupt trace header.");
+    head.input.resize(n);
+    qint64 prev = 0;
+    for (quint64 k = 0; k < n; ++k) {
+        prev += c.signedVarint();
+        head.input[k] = static_cast<int>(prev);
+    }
+    quint64 extraCount = c.varint();
+    for (quint64 e = 0; c.ok && e < extraCount; ++e) head.extraNames << c.string();
+    quint64 metaCount = c.varint();
+    for (quint64 m = 0; c.ok && m < metaCount; ++m) {
+        QString key = c.string();
+        QString value = c.string();
+        head.metadata.append({ key, value });
+    }
+    keyframeInterval = static_cast<int>(c.varint());
+    if (!c.ok || keyframeInterval <= 0) return fail("Corrupt trace header.");
+
+    quint64 footerOffset = readU64(data + size - 16);
+    if (footerOffset + 16 > static_cast<quint64>(size) - 16) return fail("Corrupt trace footer.");
+    frames = readU64(data + footerOffset);
+    keyframes = readU64(data + footerOffset + 8);
+    keyframeTable = data + footerOffset + 16;
+    if (keyframes > (static_cast<quint64>(size) - 16 - footerOffset - 16) / 8) return fail("Corrupt trace footer.");
+
+    stateFrame = -1;
+    pos = nullptr;
+    return true;
+}
+
+void TraceReader::close() {
+    if (data && fallback.isEmpty()) file.unmap(const_cast<uchar*>(data));
+    if (file.isOpen()) file.close();
+    fallback.clear();
+    data = nullptr;
+    size = 0;
+    head = TraceHeader();
+    frames = keyframes = 0;
+    keyframeTable = nullptr;
+    state = TraceFrame();
+    stateFrame = -1;
+    pos = nullptr;
+}
+
+bool TraceReader::loadKeyframe(quint64 index) {
+    if (index >= keyframes) return false;
+    quint64 offset = readU64(keyframeTable + 8 * index);
+    if (offset >= static_cast<quint64>(size)) return false;
+
+    pos = data + offset;
+    stateFrame = static_cast<int>(index * keyframeInterval) - 1;
+    return decodeRecord();
+}
+
+// Decodes the record at 'pos': a keyframe replaces the state, a frame applies its changes.
+bool TraceReader::decodeRecord() {
+    Cursor c{ pos, data + size };
+    uchar tag = c.byte();
+    const int n = static_cast<int>(head.input.size());
+
+    if (tag == 'K') {
+        state.array.resize(n);
+        qint64 prev = 0;
+        for (int k = 0; k < n; ++k) {
+            prev += c.signedVarint();
+            state.array[k] = static_cast<int>(prev);
+        }
+        state.sorted.clear();
+        quint64 intervals = c.varint();
+        quint64 at = 0;
+        for (quint64 r = 0; c.ok && r < intervals; ++r) {
+            at += c.varint();
+            quint64 len = c.varint();
+            if (at + len > static_cast<quint64>(n)) return false;
+            for (quint64 k = at; k < at + len; ++k) state.sorted.insert(static_cast<int>(k));
+            at += len;
+        }
+        state.extras.resize(head.extraNames.size());
+        for (int& e : state.extras) e = static_cast<int>(c.signedVarint());
+        state.i = state.j = state.pivot = -1;
+    }
+    else if (tag == 'F') {
+        quint64 changes = c.varint();
+        qint64 index = -1;
+        for (quint64 m = 0; c.ok && m < changes; ++m) {
+            index += static_cast<qint64>(c.varint()) + 1;
+            if (index >= n) return false;
+            state.array[index] = static_cast<int>(state.array[index] + c.signedVarint());
+        }
+        state.i = static_cast<int>(c.varint()) - 1;
+        state.j = static_cast<int>(c.varint()) - 1;
+        state.pivot = static_cast<int>(c.varint()) - 1;
+
+        quint64 settled = c.varint();
+        index = -1;
+        for (quint64 m = 0; c.ok && m < settled; ++m) {
+            index += static_cast<qint64>(c.varint()) + 1;
+            if (index >= n) return false;
+            state.sorted.insert(static_cast<int>(index));
+        }
+        for (int& e : state.extras) e = static_cast<int>(e + c.signedVarint());
+        ++stateFrame;
+    }
+    else {
+        return false;
+    }
+
+    pos = c.p;
+    return c.ok;
+}
+
+bool TraceReader::seek(int frame) {
+    if (!data || frame < 0 || static_cast<quint64>(frame) >= frames) return false;
+
+    // moving forward within a keyframe interval: just keep decoding
+    bool continueForward = stateFrame >= 0 && frame >= stateFrame && frame - stateFrame < keyframeInterval;
+    if (!continueForward) {
+        if (!loadKeyframe(static_cast<quint64>(frame / keyframeInterval))) {
+            error = "Corrupt trace data.";
+            return false;
+        }
+    }
+
+    while (stateFrame < frame) {
+        if (!decodeRecord()) {
+            error = "Corrupt trace data.";
+            stateFrame = -1;
+            return false;
+        }
+    }
+    return true;
+}
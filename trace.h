@@ -0,0 +1,116 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+#include "sortedindexset.h"
+
+/*
+ * Binary trace file: a recorded run that can be replayed without rerunning the sort.
+ *
+ *   header    "SATR", u32 version, algorithm, input array, names of the per-frame extras,
+ *             metadata pairs, keyframe interval
+ *   stream    'K' keyframe every <interval> frames (full array, sorted intervals, extras),
+ *             'F' frame: changed elements, i/j/pivot, newly sorted indices, extras deltas
+ *   footer    u64 frame count, u64 keyframe count, u64 byte offset of every keyframe
+ *   trailer   u64 footer offset, "SATREND1"
+ *
+ * Integers are LEB128 varints; signed values are zigzag coded and stored as deltas (array values
+ * against the previous element or previous value, indices as gaps), so typical frames take a few bytes.
+ */
+
+struct TraceHeader {
+    QString algorithm;
+    std::vector<int> input;
+    QStringList extraNames;                    // algorithm-specific state recorded with every frame
+    QList<QPair<QString, QString>> metadata;
+};
+
+// State of the run after one frame.
+struct TraceFrame {
+    std::vector<int> array;
+    SortedIndexSet sorted;
+    int i = -1, j = -1, pivot = -1;
+    std::vector<int> extras;
+};
+
+class TraceWriter
+{
+public:
+    ~TraceWriter();
+
+    bool open(const QString& path, const TraceHeader& header);
+    // newlySorted: indices that became sorted in this frame. Finds the changed elements by
+    // comparing the whole array with the previous frame.
+    void addFrame(const std::vector<int>& array, int i, int j, int pivot,
+                  const std::vector<int>& newlySorted, const std::vector<int>& extras);
+    // Same, for a caller that knows which indices it wrote since the last frame (in any order,
+    // repeats allowed): only those are looked at, so a frame costs O(changed) instead of O(n).
+    void addFrame(const std::vector<int>& array, const std::vector<int>& changed, int i, int j, int pivot,
+                  const std::vector<int>& newlySorted, const std::vector<int>& extras);
+    bool finish();
+    QString errorString() const { return error; }
+
+private:
+    void writeKeyframe();
+    void flush();
+
+    QFile file;
+    QByteArray buffer;
+    QString error;
+    qint64 flushed = 0;
+
+    std::vector<int> current;
+    std::vector<int> currentExtras;
+    std::vector<int> written; // the changed indices of the frame being added, sorted
+    SortedIndexSet sorted;
+    std::vector<quint64> keyframeOffsets;
+    quint64 frameCount = 0;
+    int keyframeInterval = 256;
+};
+
+// Reads a trace through a memory mapping. open() only parses the header and footer, so even
+// a trace with 100M frames opens instantly; seek() decodes from the nearest keyframe, or just
+// continues from the current frame when moving forward.
+class TraceReader
+{
+public:
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+    QString errorString() const { return error; }
+
+    const TraceHeader& header() const { return head; }
+    int frameCount() const { return static_cast<int>(frames); }
+
+    bool seek(int frame);
+    const TraceFrame& frame() const { return state; }
+
+private:
+    bool loadKeyframe(quint64 index);
+    bool decodeRecord();
+
+    QFile file;
+    QByteArray fallback; // used when the file system cannot map the file
+    const uchar* data = nullptr;
+    qint64 size = 0;
+    QString error;
+
+    TraceHeader head;
+    int keyframeInterval = 1;
+    quint64 frames = 0;
+    quint64 keyframes = 0;
+    const uchar* keyframeTable = nullptr;
+
+    TraceFrame state;
+    int stateFrame = -1;        // frame currently decoded into 'state'
+    const uchar* pos = nullptr; // next record after stateFrame
+};
+
+#endif // TRACE_H